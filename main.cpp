@@ -3,8 +3,24 @@
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <math.h>
+#include <ctype.h>
 
 #include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory_resource>
+#include <new>
+
+#if __SSE2__
+#include <immintrin.h>
+#endif
 
 // keywords are reserved words that are counted as separate tokens; we make no distinction between keywords and operators; keyword prefix disambiguation
 // is ensured when list is traversed sequentially in one direction -- keywords that are prefixes to other keywords come later in the list
@@ -14,7 +30,7 @@
 //   this_is_a_keyword,
 //   this // another keyword
 //
-const char* keywords[] = { // keep order in sync with Token enum below to maintain a mapping shortcut
+constexpr const char* keywords[] = { // keep order in sync with Token enum below to maintain a mapping shortcut
 	"(",
 	")",
 	"defun",
@@ -31,7 +47,7 @@ const char* keywords[] = { // keep order in sync with Token enum below to mainta
 };
 
 // unlike keywords, a contiguous sequence of separators collapses into a single separator, which vanishes before reaching the token stream
-const char separators[] = {
+constexpr char separators[] = {
 	' ',
 	'\t',
 	'\r',
@@ -104,6 +120,142 @@ const char* stringFromToken(const Token t)
 	return "alien-token";
 }
 
+// arena -- a monotonic memory resource for the containers of the front end and the evaluator, over memory mapped from the OS
+// and released in bulk at destruction; requests too large for a chunk get a mapping of their own, returned as soon as the
+// request is deallocated, so that growing a large container does not accumulate dead copies of it
+struct Arena : std::pmr::memory_resource {
+	// header of a mapping; aligns the payload to a cache line
+	struct alignas(64) Block {
+		Block* prev;
+		Block* next;
+		size_t size; // mapping size, header included
+	};
+
+	static const size_t chunkSize = size_t(1) << 21; // a huge page
+	static const size_t largeSize = chunkSize / 4;   // requests of this size and larger get their own mapping
+
+	bool   hugePages = false;  // advise transparent huge pages for mappings
+	Block* chunks = nullptr;   // chunks allocated from in bump order, most recent first
+	Block* large = nullptr;    // mappings of large requests
+	char*  cursor = nullptr;   // next free byte in the most recent chunk
+	char*  limit = nullptr;    // end of the most recent chunk
+
+	size_t allocCount = 0;     // count of requests
+	size_t allocBytes = 0;     // requested bytes
+	size_t mapCount = 0;       // count of mappings
+	size_t mapBytes = 0;       // mapped bytes
+
+	~Arena() { release(); }
+	void release();
+
+private:
+	Block* map(const size_t size);
+	void unmap(Block* block);
+
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// map a block of at least the specified size, header included
+Arena::Block* Arena::map(const size_t size)
+{
+	const size_t pageSize = 4096;
+	const size_t mapSize = (size + pageSize - 1) & ~(pageSize - 1);
+	void* const addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (MAP_FAILED == addr)
+		throw std::bad_alloc();
+
+	if (hugePages)
+		madvise(addr, mapSize, MADV_HUGEPAGE);
+
+	mapCount++;
+	mapBytes += mapSize;
+
+	Block* const block = static_cast< Block* >(addr);
+	block->prev = nullptr;
+	block->next = nullptr;
+	block->size = mapSize;
+	return block;
+}
+
+void Arena::unmap(Block* block)
+{
+	munmap(block, block->size);
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	assert(alignment <= alignof(Block));
+
+	allocCount++;
+	allocBytes += bytes;
+
+	if (largeSize <= bytes) {
+		Block* const block = map(sizeof(Block) + bytes);
+
+		if (large)
+			large->prev = block;
+
+		block->next = large;
+		large = block;
+		return block + 1;
+	}
+
+	char* p = reinterpret_cast< char* >((uintptr_t(cursor) + alignment - 1) & ~uintptr_t(alignment - 1));
+
+	if (nullptr == cursor || limit - p < ptrdiff_t(bytes)) {
+		Block* const block = map(chunkSize);
+		block->next = chunks;
+		chunks = block;
+
+		p = reinterpret_cast< char* >(block + 1);
+		limit = reinterpret_cast< char* >(block) + block->size;
+	}
+
+	cursor = p + bytes;
+	return p;
+}
+
+void Arena::do_deallocate(void* p, size_t bytes, size_t)
+{
+	// chunk space is reclaimed in bulk only
+	if (bytes < largeSize)
+		return;
+
+	Block* const block = static_cast< Block* >(p) - 1;
+
+	if (block->prev)
+		block->prev->next = block->next;
+	else
+		large = block->next;
+
+	if (block->next)
+		block->next->prev = block->prev;
+
+	unmap(block);
+}
+
+// return all mappings to the OS; any memory obtained from the arena so far becomes invalid
+void Arena::release()
+{
+	while (chunks) {
+		Block* const next = chunks->next;
+		unmap(chunks);
+		chunks = next;
+	}
+
+	while (large) {
+		Block* const next = large->next;
+		unmap(large);
+		large = next;
+	}
+
+	cursor = nullptr;
+	limit = nullptr;
+}
+
 // a ref to an immutable sequence of T
 template < typename T >
 struct SeqRef {
@@ -113,62 +265,173 @@ struct SeqRef {
 
 typedef SeqRef< char > StrRef;
 
-// a token as found in the source stream
-struct TokenInStream {
-	StrRef   val;
-	uint32_t row;
-	uint32_t col;
-	union {
-		int32_t literal_i32;
-		float   literal_f32;
+// dense identifier IDs, AKA symbols; symbol zero is reserved for 'no symbol'
+typedef uint32_t Symbol;
+
+const Symbol nullsym = 0;
+
+// table of interned identifiers: open addressing with linear probing, over a power-of-two count of slots kept at most half full;
+// names are copied into the table, so that the source they were found in can be released
+struct SymbolTable {
+	// extent of a name in the text of names
+	struct Name {
+		size_t   start;
+		uint32_t len;
 	};
-	Token token;
 
-	void print(FILE* f) const;
+	std::pmr::vector<char>     text;   // names back to back
+	std::pmr::vector<Name>     names;  // per symbol
+	std::pmr::vector<uint32_t> hashes; // per symbol
+	std::pmr::vector<Symbol>   slots;
+
+	Symbol intern(const StrRef& name);
+	StrRef getName(const Symbol sym) const;
+	size_t size() const { return names.size(); }
+
+	static uint32_t getHash(const StrRef& name);
 };
 
-void TokenInStream::print(FILE* f) const
+// FNV-1a
+uint32_t SymbolTable::getHash(const StrRef& name)
 {
-	const char* const stringToken = stringFromToken(token);
+	uint32_t hash = 2166136261u;
 
-	if (TOKEN_LITERAL_I32 == token) {
-		fprintf(f, "{\n\t"
-			"%s: %d\n\t"
-			"%p, %u\n\t"
-			"%u, %u\n}",
-			stringToken, literal_i32, val.ptr, val.len, row, col);
-	}
-	else
-	if (TOKEN_LITERAL_F32 == token) {
-		fprintf(f, "{\n\t"
-			"%s: %f\n\t"
-			"%p, %u\n\t"
-			"%u, %u\n}",
-			stringToken, literal_f32, val.ptr, val.len, row, col);
+	for (uint32_t i = 0; i < name.len; ++i)
+		hash = (hash ^ uint8_t(name.ptr[i])) * 16777619u;
+
+	return hash;
+}
+
+StrRef SymbolTable::getName(const Symbol sym) const
+{
+	assert(nullsym != sym && sym <= names.size());
+	const Name& name = names[sym - 1];
+	return StrRef{ .ptr = text.data() + name.start, .len = name.len };
+}
+
+// get the symbol of an identifier, introducing a new symbol at the first encounter of the identifier
+Symbol SymbolTable::intern(const StrRef& name)
+{
+	assert(name.ptr && name.len);
+	const uint32_t hash = getHash(name);
+
+	if (!slots.empty()) {
+		const size_t mask = slots.size() - 1;
+
+		for (size_t i = hash & mask; nullsym != slots[i]; i = (i + 1) & mask) {
+			const Symbol sym = slots[i];
+			const Name& symName = names[sym - 1];
+
+			if (hash == hashes[sym - 1] && name.len == symName.len && 0 == memcmp(name.ptr, text.data() + symName.start, name.len))
+				return sym;
+		}
 	}
-	else
-	if (TOKEN_IDENTIFIER == token) {
-		fprintf(f, "{\n\t"
-			"%s: %.*s\n\t"
-			"%p, %u\n\t"
-			"%u, %u\n}",
-			stringToken, val.len, val.ptr, val.ptr, val.len, row, col);
+
+	names.push_back(Name{ .start = text.size(), .len = name.len });
+	text.insert(text.end(), name.ptr, name.ptr + name.len);
+	hashes.push_back(hash);
+	const Symbol sym = Symbol(names.size());
+
+	// grow at half occupancy, re-inserting all symbols
+	if (slots.size() < names.size() * 2) {
+		slots.assign(slots.empty() ? 64 : slots.size() * 2, nullsym);
+		const size_t mask = slots.size() - 1;
+
+		for (Symbol s = 1; s <= names.size(); ++s) {
+			size_t i = hashes[s - 1] & mask;
+			while (nullsym != slots[i])
+				i = (i + 1) & mask;
+			slots[i] = s;
+		}
 	}
 	else {
-		fprintf(f, "{\n\t"
-			"%s\n\t"
-			"%p, %u\n\t"
-			"%u, %u\n}",
-			stringToken, val.ptr, val.len, row, col);
+		const size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+		while (nullsym != slots[i])
+			i = (i + 1) & mask;
+		slots[i] = sym;
 	}
+
+	return sym;
 }
 
+// token stream as found in the source, in structure-of-arrays layout: a kind and a source offset per token, with literal
+// values, identifier symbols and parenthesis extents on the side, for only the tokens that have those, found by the rank of a
+// token in a bitmap of such tokens; rows and columns are recovered from a table of new-line offsets, as those are only needed at
+// error reporting; offsets are 32-bit and relative to the earliest retained source span, as erasing leading tokens drops
+// consumed spans and rebases the rest, so a stream is limited only in the extent of its unconsumed source
+struct TokenStream {
+	// a contiguous span of source
+	struct Span {
+		const char* ptr;
+		uint32_t    start; // offset of span
+		uint32_t    len;
+	};
+
+	// a literal value and extent, an identifier symbol and extent, or the count of tokens through the matching right parenthesis
+	// of a left parenthesis, zero if none
+	struct Payload {
+		uint32_t len;
+		union {
+			int32_t  literal_i32;
+			float    literal_f32;
+			Symbol   symbol;
+			uint32_t extent;
+		};
+	};
+
+	std::pmr::vector<uint8_t>  kind;     // per-token kind
+	std::pmr::vector<uint32_t> offset;   // per-token offset
+	std::pmr::vector<uint64_t> marks;    // per-token bit: token has a payload, i.e. is a literal, an identifier or a left parenthesis
+	std::pmr::vector<uint32_t> ranks;    // per 64 tokens: count of payloads of the tokens before
+	std::pmr::vector<uint32_t> open;     // indices of unmatched left parentheses, innermost last
+	size_t                     stray = size_t(-1); // index of the first unmatched right parenthesis
+	std::pmr::vector<Payload>  payloads; // ordered by token
+	std::pmr::vector<uint32_t> newlines; // ordered new-line offsets
+	std::pmr::vector<Span>     spans;    // ordered by offset
+	uint32_t                   end = 0;  // offset past the last span
+	uint64_t                   base = 0; // global offset of offset zero
+	uint64_t                   lineStart = 0; // global offset of the line following the last dropped new-line
+	size_t                     rowBase = 0;   // count of dropped new-lines
+	SymbolTable                symbols;
+
+	size_t size() const { return kind.size(); }
+	bool empty() const { return kind.empty(); }
+	Token token(const size_t i) const { return Token(kind[i]); }
+	int32_t literal_i32(const size_t i) const { return getPayload(i).literal_i32; }
+	float literal_f32(const size_t i) const { return getPayload(i).literal_f32; }
+	Symbol symbol(const size_t i) const { return getPayload(i).symbol; }
+	uint32_t extent(const size_t i) const { return getPayload(i).extent; }
+	size_t row(const size_t i) const;
+	size_t col(const size_t i) const;
+	StrRef val(const size_t i) const;
+
+	bool hasPayload(const size_t i) const { return marks[i / 64] >> (i % 64) & 1; }
+	size_t rank(const size_t i) const;
+	const Payload& getPayload(const size_t i) const;
+	const Span& getSpan(const uint32_t pos) const;
+	void getRowCol(const uint32_t pos, size_t& row, size_t& col) const;
+	void push(const Token t, const uint32_t pos);
+	void erase(const size_t count);
+	void print(FILE* f, const size_t i) const;
+};
+
 // countof helper
 template < typename T, size_t N >
 int8_t (& noneval_countof(const T (&)[N]))[N];
 
 #define countof(x) sizeof(noneval_countof(x))
 
+// bit_cast helper
+template < typename T, typename S >
+T bit_cast(const S& src)
+{
+	static_assert(sizeof(T) == sizeof(S), "bit_cast requires types of the same size");
+	T dst;
+	memcpy(&dst, &src, sizeof(dst));
+	return dst;
+}
+
 // check a stream location for stream terminator
 bool isTerminator(const char* str)
 {
@@ -182,19 +445,65 @@ enum TriState : uint8_t {
 	TRI_SECOND
 };
 
+// character classes, as bits in a per-character mask
+enum : uint8_t {
+	CHAR_SEPARATOR  = 1 << 0, // separator other than new-line, stream terminator included
+	CHAR_NEWLINE    = 1 << 1, // new-line separator
+	CHAR_IDENTIFIER = 1 << 2, // allowed in an identifier: 0-9 A-Z _ a-z
+	CHAR_LITERAL    = 1 << 3  // allowed in a numeric literal: 0-9 A-F a-f
+};
+
+// compile-time generated character-class table, indexed by unsigned character
+struct CharClassTable {
+	uint8_t mask[256];
+	uint8_t digit[256]; // numeric value of a hexadecimal digit, 0xff if not a digit
+
+	constexpr CharClassTable() : mask(), digit() {
+		for (size_t i = 0; i < countof(digit); ++i)
+			digit[i] = 0xff;
+		for (unsigned c = '0'; c <= '9'; ++c)
+			digit[c] = c - '0';
+		for (unsigned c = 'A'; c <= 'F'; ++c)
+			digit[c] = c - 'A' + 10;
+		for (unsigned c = 'a'; c <= 'f'; ++c)
+			digit[c] = c - 'a' + 10;
+
+		mask[uint8_t('\0')] = CHAR_SEPARATOR;
+
+		for (size_t i = 0; i < countof(separators) - 1; ++i)
+			mask[uint8_t(separators[i])] = CHAR_SEPARATOR;
+
+		mask[uint8_t(separators[countof(separators) - 1])] = CHAR_NEWLINE;
+
+		for (unsigned c = '0'; c <= '9'; ++c)
+			mask[c] = CHAR_IDENTIFIER | CHAR_LITERAL;
+		for (unsigned c = 'A'; c <= 'Z'; ++c)
+			mask[c] = CHAR_IDENTIFIER | ('F' >= c ? CHAR_LITERAL : 0);
+		for (unsigned c = 'a'; c <= 'z'; ++c)
+			mask[c] = CHAR_IDENTIFIER | ('f' >= c ? CHAR_LITERAL : 0);
+
+		mask[uint8_t('_')] = CHAR_IDENTIFIER;
+	}
+};
+
+constexpr CharClassTable charClass;
+
+// get the class mask of a stream location
+uint8_t getCharClass(const char* str)
+{
+	assert(str);
+	return charClass.mask[uint8_t(*str)];
+}
+
 // check a stream location for separators; return TRI_FALSE if not a separator, TRI_PRIME if separator is new-line, and TRI_SECOND otherwise
 TriState isSeparator(const char* str)
 {
-	assert(countof(separators));
+	const uint8_t cc = getCharClass(str);
 
-	if (isTerminator(str))
+	if (CHAR_SEPARATOR & cc)
 		return TRI_SECOND;
 
-	for (size_t i = 0; i < countof(separators) - 1; ++i)
-		if (*str == separators[i])
-			return TRI_SECOND;
-
-	if (*str == separators[countof(separators) - 1])
+	if (CHAR_NEWLINE & cc)
 		return TRI_PRIME;
 
 	return TRI_FALSE;
@@ -203,41 +512,36 @@ TriState isSeparator(const char* str)
 // check if a stream location can be a part of an identifier; allowed: 0-9 A-Z _ a-z
 bool isAllowedIdentifier(const char* str)
 {
-	if (isSeparator(str))
-		return false;
-
-	if ('0' <= *str && '9' >= *str)
-		return true;
-
-	if ('A' <= *str && 'Z' >= *str)
-		return true;
-
-	if ('_' == *str)
-		return true;
-
-	if ('a' <= *str && 'z' >= *str)
-		return true;
-
-	return false;
+	return CHAR_IDENTIFIER & getCharClass(str);
 }
 
 // check if a stream location can be a part of a numeric literal; allowed: 0-9 A-F a-f
 bool isAllowedLiteral(const char* str)
 {
-	if (isSeparator(str))
-		return false;
+	return CHAR_LITERAL & getCharClass(str);
+}
 
-	if ('0' <= *str && '9' >= *str)
-		return true;
+// compile-time generated keyword lookup: per leading character, a mask of the keywords starting with that character, bit
+// positions following keyword order; traversing a mask from low to high bits keeps the front-to-back prefix disambiguation
+struct KeywordTable {
+	uint16_t byFirst[256];
+	uint8_t len[countof(keywords)];
 
-	if ('A' <= *str && 'F' >= *str)
-		return true;
+	constexpr KeywordTable() : byFirst(), len() {
+		static_assert(countof(keywords) <= 16, "keyword masks overflow");
 
-	if ('a' <= *str && 'f' >= *str)
-		return true;
+		for (size_t i = 0; i < countof(keywords); ++i) {
+			size_t n = 0;
+			while (keywords[i][n])
+				n++;
 
-	return false;
-}
+			len[i] = uint8_t(n);
+			byFirst[uint8_t(keywords[i][0])] |= uint16_t(1) << i;
+		}
+	}
+};
+
+constexpr KeywordTable keywordTable;
 
 // check if a stream location is a positive/negative sign; return TRI_FALSE if not a sign, TRI_PRIME if positive, and TRI_SECOND if negative
 TriState isSign(const char* str)
@@ -264,10 +568,263 @@ bool isDecimalPoint(const char* str)
 	return false;
 }
 
-// get a single context-free token from the specified stream location; tokens are recognized as belonging to one of four categories, in decreasing precedence:
-// literals > keywords > identifiers > unknown
-Token getToken(const char* str, uint32_t& tokenLen, int32_t& lit_i32, float& lit_f32)
+// get the numeric value of a digit at a stream location; return a value not less than the base if not a digit in that base
+unsigned getDigit(const char* str)
+{
+	assert(str);
+	return charClass.digit[uint8_t(*str)];
+}
+
+// read an unsigned integer of the specified base from a span, saturating at uint64 max; return false if the span is empty or not all digits
+bool readUnsigned(const char* str, const size_t len, const unsigned base, uint64_t& val, bool& overflow)
+{
+	val = 0;
+	overflow = false;
+
+	if (!len)
+		return false;
+
+	for (size_t i = 0; i < len; ++i) {
+		const unsigned d = getDigit(str + i);
+		if (base <= d)
+			return false;
+
+		if (val > (uint64_t(-1) - d) / base) {
+			val = uint64_t(-1);
+			overflow = true;
+		}
+		else
+		if (!overflow)
+			val = val * base + d;
+	}
+
+	return true;
+}
+
+// parse a hexadecimal integer literal without sign or hexadecimal prefix; follow scanf's %x semantics -- the
+// numeral is read as an unsigned long (64 bits, saturating) and truncated to 32 bits
+bool parseLiteralHex(const char* str, const size_t len, int32_t& lit)
+{
+	uint64_t val;
+	bool overflow;
+
+	if (!readUnsigned(str, len, 16, val, overflow))
+		return false;
+
+	lit = int32_t(uint32_t(val));
+	return true;
+}
+
+// parse a decimal integer literal with an optional sign; follow scanf's %d semantics -- the numeral is read as
+// a long (64 bits, saturating) and truncated to 32 bits
+bool parseLiteralDec(const char* str, const size_t len, int32_t& lit)
+{
+	assert(len);
+	const TriState sign = isSign(str);
+	const size_t offset = sign ? 1 : 0;
+
+	uint64_t val;
+	bool overflow;
+
+	if (!readUnsigned(str + offset, len - offset, 10, val, overflow))
+		return false;
+
+	const uint64_t max_i64 = uint64_t(-1) >> 1;
+
+	if (TRI_SECOND == sign)
+		val = overflow || max_i64 + 1 < val ? max_i64 + 1 : 0 - val;
+	else
+		val = overflow || max_i64 < val ? max_i64 : val;
+
+	lit = int32_t(uint32_t(val));
+	return true;
+}
+
+// powers of ten exactly representable in f32
+const float pow10_f32[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// parse a floating-point literal with an optional sign and an optional hexadecimal prefix, accepting what scanf's %f
+// accepts out of the literal-allowed characters: a non-empty mantissa with an optional decimal point, and for decimal
+// literals an optional exponent whose digits may be missing; mantissas and exponents small enough to convert with a
+// single rounding are computed directly, everything else is deferred to strtof for correct rounding
+bool parseLiteralF32(const char* str, const size_t len, const bool hex, float& lit)
+{
+	assert(len);
+	const TriState sign = isSign(str);
+	size_t i = sign ? 1 : 0;
+
+	if (hex)
+		i += 2;
+
+	const unsigned base = hex ? 16 : 10;
+	const size_t maxDigits = hex ? 15 : 19; // significant digits that fit in 60 and 63 bits, respectively
+
+	uint64_t mantissa = 0;
+	int64_t exponent = 0; // in mantissa digits
+	size_t digits = 0;
+	size_t significant = 0;
+	bool truncated = false;
+	bool point = false;
+
+	for (bool frac = false; i < len; ++i) {
+		if (!frac && isDecimalPoint(str + i)) {
+			frac = point = true;
+			continue;
+		}
+
+		const unsigned d = getDigit(str + i);
+		if (base <= d)
+			break;
+
+		digits++;
+
+		if (significant < maxDigits && (mantissa || d)) {
+			mantissa = mantissa * base + d;
+			significant++;
+			exponent -= frac;
+		}
+		else {
+			truncated |= significant == maxDigits && d;
+			exponent += significant == maxDigits && !frac;
+			exponent -= !mantissa && frac;
+		}
+	}
+
+	// hexadecimal mantissas may consist of a sole decimal point
+	if (!digits && !(hex && point))
+		return false;
+
+	// decimal exponent digits are optional
+	if (!hex && i < len && ('e' == str[i] || 'E' == str[i])) {
+		uint64_t expval;
+		bool overflow;
+
+		if (i + 1 < len && !readUnsigned(str + i + 1, len - i - 1, 10, expval, overflow))
+			return false;
+
+		if (i + 1 < len)
+			exponent += overflow || expval > 100000 ? 100000 : int64_t(expval);
+
+		i = len;
+	}
+
+	if (i != len)
+		return false;
+
+	float val;
+
+	if (!mantissa)
+		val = 0.f;
+	else
+	if (!hex && !truncated && mantissa <= uint64_t(1) << 24 && -10 <= exponent && exponent <= 10)
+		val = 0 > exponent ? float(mantissa) / pow10_f32[-exponent] : float(mantissa) * pow10_f32[exponent];
+	else
+	if (hex && !truncated && -25 <= exponent && exponent <= 15)
+		val = ldexpf(float(int64_t(mantissa)), int(exponent * 4));
+	else {
+		std::vector<char> buf(str + (sign ? 1 : 0), str + len);
+		buf.push_back('\0');
+
+		val = strtof(buf.data(), nullptr);
+	}
+
+	lit = TRI_SECOND == sign ? -val : val;
+	return true;
+}
+
+// get a numeric literal of the specified length from a stream location, trying integers before floats; return TOKEN_UNKNOWN if not a valid literal
+Token getLiteral(const char* str, const size_t len, const TriState hassign, const bool hex, int32_t& lit_i32, float& lit_f32)
+{
+	if (hex) {
+		// try reading a hexadecimal integer
+		int32_t i32;
+		const size_t offset = hassign ? 3 : 2; // account for sign and hex prefix
+
+		// get the numeral by absolute value, then adjust the sign if needed
+		if (parseLiteralHex(str + offset, len - offset, i32)) {
+			lit_i32 = TRI_SECOND == hassign ? int32_t(0u - uint32_t(i32)) : i32;
+			return TOKEN_LITERAL_I32;
+		}
+	}
+	else {
+		// try reading a decimal integer
+		if (parseLiteralDec(str, len, lit_i32))
+			return TOKEN_LITERAL_I32;
+	}
+
+	// try reading a float, either decimal or hexadecimal
+	if (parseLiteralF32(str, len, hex, lit_f32))
+		return TOKEN_LITERAL_F32;
+
+	return TOKEN_UNKNOWN;
+}
+
+// differential check of a literal against the reference sscanf-based reading of the same span
+bool checkLiteral(const char* str, const size_t len, const TriState hassign, const bool hex, const Token token, const int32_t lit_i32, const float lit_f32)
+{
+	std::vector<char> buf(str, str + len);
+	buf.push_back('\0');
+
+	int consumed = 0;
+	Token ref = TOKEN_UNKNOWN;
+	int i32;
+	float f32;
+
+	if (hex) {
+		const size_t offset = hassign ? 3 : 2;
+
+		if (1 == sscanf(buf.data() + offset, "%x%n", &i32, &consumed) && consumed == len - offset) {
+			i32 = TRI_SECOND == hassign ? int32_t(0u - uint32_t(i32)) : i32;
+			ref = TOKEN_LITERAL_I32;
+		}
+	}
+	else
+	if (1 == sscanf(buf.data(), "%d%n", &i32, &consumed) && consumed == len)
+		ref = TOKEN_LITERAL_I32;
+
+	if (TOKEN_UNKNOWN == ref && 1 == sscanf(buf.data(), "%f%n", &f32, &consumed) && consumed == len)
+		ref = TOKEN_LITERAL_F32;
+
+	if (ref != token)
+		return false;
+
+	if (TOKEN_LITERAL_I32 == ref)
+		return i32 == lit_i32;
+
+	if (TOKEN_LITERAL_F32 == ref)
+		return 0 == memcmp(&f32, &lit_f32, sizeof(f32));
+
+	return true;
+}
+
+// bounded versions of the stream location checks; locations at or past the end of the stream are terminators
+bool isAllowedIdentifier(const char* str, const char* end)
+{
+	return str < end && isAllowedIdentifier(str);
+}
+
+bool isAllowedLiteral(const char* str, const char* end)
+{
+	return str < end && isAllowedLiteral(str);
+}
+
+TriState isSign(const char* str, const char* end)
+{
+	return str < end ? isSign(str) : TRI_FALSE;
+}
+
+bool isDecimalPoint(const char* str, const char* end)
 {
+	return str < end && isDecimalPoint(str);
+}
+
+// get a single context-free token from the specified location of a stream ending at the specified end; tokens are recognized as belonging to one of four
+// categories, in decreasing precedence: literals > keywords > identifiers > unknown
+Token getToken(const char* str, const char* end, uint32_t& tokenLen, int32_t& lit_i32, float& lit_f32)
+{
+	assert(str < end);
 	assert(!isSeparator(str));
 
 	// check for a numeric literal
@@ -280,65 +837,43 @@ Token getToken(const char* str, uint32_t& tokenLen, int32_t& lit_i32, float& lit
 		tokend++;
 
 	// a numeric literal may have a hexadecimal prefix
-	if ('0' == tokend[0] && ('X' == tokend[1] || 'x' == tokend[1])) {
+	if (2 <= end - tokend && '0' == tokend[0] && ('X' == tokend[1] || 'x' == tokend[1])) {
 		tokend += 2;
 		hex = true;
 	}
 
-	while (isAllowedLiteral(tokend))
+	while (isAllowedLiteral(tokend, end))
 		tokend++;
 
 	// a numeric literal may contain a decimal point, but any subsequent occurrences of decimal points void the literal
-	if (isDecimalPoint(tokend)) {
+	if (isDecimalPoint(tokend, end)) {
 		tokend++;
 
-		while (isAllowedLiteral(tokend))
+		while (isAllowedLiteral(tokend, end))
 			tokend++;
 	}
 
 	// heuristics to tell literals from literal-prefixed identifiers: if a literal ends with an identifier-allowed character, next character should not be identifier-allowed
-	if (tokend != str && !isSign(tokend) && !isDecimalPoint(tokend) && (!isAllowedIdentifier(tokend - 1) || !isAllowedIdentifier(tokend))) {
+	if (tokend != str && !isSign(tokend, end) && !isDecimalPoint(tokend, end) && (!isAllowedIdentifier(tokend - 1) || !isAllowedIdentifier(tokend, end))) {
 		const size_t toklen = tokend - str;
-		int consumed = 0;
-
-		if (hex) {
-			// try reading a hexadecimal integer
-			int i32;
-			const size_t offset = hassign ? 3 : 2; // account for sign and hex prefix
-
-			// get the numeral by absolute value, then adjust the sign if needed
-			if (1 == sscanf(str + offset, "%x%n", &i32, &consumed) && consumed == toklen - offset) {
-				lit_i32 = TRI_SECOND == hassign ? -i32 : i32;
-				tokenLen = toklen;
-				return TOKEN_LITERAL_I32;
-			}
-		}
-		else {
-			// try reading a decimal integer
-			int i32;
-			if (1 == sscanf(str, "%d%n", &i32, &consumed) && consumed == toklen) {
-				lit_i32 = i32;
-				tokenLen = toklen;
-				return TOKEN_LITERAL_I32;
-			}
-		}
+		const Token literal = getLiteral(str, toklen, hassign, hex, lit_i32, lit_f32);
+		assert(checkLiteral(str, toklen, hassign, hex, literal, lit_i32, lit_f32));
 
-		// try reading a float, either decimal or hexadecimal
-		float f32;
-		if (1 == sscanf(str, "%f%n", &f32, &consumed) && consumed == toklen) {
-			lit_f32 = f32;
+		if (TOKEN_UNKNOWN != literal) {
 			tokenLen = toklen;
-			return TOKEN_LITERAL_F32;
+			return literal;
 		}
 	}
 
-	// check for keywords; traverse keyword list front-to-back
-	for (size_t i = 0; i < countof(keywords); ++i) {
-		const size_t keywordLen = strlen(keywords[i]);
+	// check for keywords; traverse the keywords sharing our leading character front-to-back
+	for (uint16_t mask = keywordTable.byFirst[uint8_t(*str)]; mask; mask &= mask - 1) {
+		const size_t i = __builtin_ctz(mask);
+		const size_t keywordLen = keywordTable.len[i];
 		assert(keywordLen);
 
 		// heuristics to tell keywords from keyword-prefixed identifiers: if a keyword ends with an identifier-allowed character, next character should not be identifier-allowed
-		if (0 == strncmp(str, keywords[i], keywordLen) && (!isAllowedIdentifier(str + keywordLen - 1) || !isAllowedIdentifier(str + keywordLen))) {
+		if (keywordLen <= size_t(end - str) && 0 == memcmp(str + 1, keywords[i] + 1, keywordLen - 1) &&
+			(!isAllowedIdentifier(str + keywordLen - 1) || !isAllowedIdentifier(str + keywordLen, end))) {
 			tokenLen = keywordLen;
 			return Token(i + 1); // mapping shortcut avoids a level of indirection
 		}
@@ -346,7 +881,7 @@ Token getToken(const char* str, uint32_t& tokenLen, int32_t& lit_i32, float& lit
 
 	// check for an identifier
 	tokend = str;
-	while (isAllowedIdentifier(tokend))
+	while (isAllowedIdentifier(tokend, end))
 		tokend++;
 
 	if (tokend != str) {
@@ -358,48 +893,424 @@ Token getToken(const char* str, uint32_t& tokenLen, int32_t& lit_i32, float& lit
 	return TOKEN_UNKNOWN;
 }
 
-// tokenize a stream into tokens, keeping track of stream rows and columns
-bool tokenize(
+// structural index of a stream: one bit per stream location, 64 locations per word, for each of separators (new-line included),
+// new-lines and parentheses; built ahead of tokenization so that separator runs are skipped via bit scans rather than byte by byte
+struct StructuralIndex {
+	std::vector<uint64_t> sep;
+	std::vector<uint64_t> nl;
+	std::vector<uint64_t> paren;
+
+	bool isSet(const std::vector<uint64_t>& bits, const size_t pos) const { return bits[pos / 64] >> pos % 64 & 1; }
+	size_t getNextNonSeparator(const size_t pos, const size_t len) const;
+	void getNewLines(const uint32_t start, std::pmr::vector<uint32_t>& newlines) const;
+};
+
+// classify a block of 64 stream locations; return separator, new-line and parenthesis masks
+void indexBlock(const char* block, uint64_t& sep, uint64_t& nl, uint64_t& paren)
+{
+#if __AVX2__
+	sep = nl = paren = 0;
+
+	for (size_t i = 0; i < 64; i += 32) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast< const __m256i* >(block + i));
+		__m256i vsep = _mm256_setzero_si256();
+
+		for (size_t j = 0; j < countof(separators); ++j)
+			vsep = _mm256_or_si256(vsep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(separators[j])));
+
+		const __m256i vnl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(separators[countof(separators) - 1]));
+		const __m256i vparen = _mm256_or_si256(
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8('(')),
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8(')')));
+
+		sep |= uint64_t(uint32_t(_mm256_movemask_epi8(vsep))) << i;
+		nl |= uint64_t(uint32_t(_mm256_movemask_epi8(vnl))) << i;
+		paren |= uint64_t(uint32_t(_mm256_movemask_epi8(vparen))) << i;
+	}
+
+#elif __SSE2__
+	sep = nl = paren = 0;
+
+	for (size_t i = 0; i < 64; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast< const __m128i* >(block + i));
+		__m128i vsep = _mm_setzero_si128();
+
+		for (size_t j = 0; j < countof(separators); ++j)
+			vsep = _mm_or_si128(vsep, _mm_cmpeq_epi8(v, _mm_set1_epi8(separators[j])));
+
+		const __m128i vnl = _mm_cmpeq_epi8(v, _mm_set1_epi8(separators[countof(separators) - 1]));
+		const __m128i vparen = _mm_or_si128(
+			_mm_cmpeq_epi8(v, _mm_set1_epi8('(')),
+			_mm_cmpeq_epi8(v, _mm_set1_epi8(')')));
+
+		sep |= uint64_t(_mm_movemask_epi8(vsep)) << i;
+		nl |= uint64_t(_mm_movemask_epi8(vnl)) << i;
+		paren |= uint64_t(_mm_movemask_epi8(vparen)) << i;
+	}
+
+#else
+	sep = nl = paren = 0;
+
+	for (size_t i = 0; i < 64; ++i) {
+		// stream terminator is a separator to the lexer, but it stops tokenization so keep it out of the index
+		const uint8_t cc = '\0' != block[i] ? getCharClass(block + i) : 0;
+
+		sep |= uint64_t(0 != (cc & (CHAR_SEPARATOR | CHAR_NEWLINE))) << i;
+		nl |= uint64_t(0 != (cc & CHAR_NEWLINE)) << i;
+		paren |= uint64_t('(' == block[i] || ')' == block[i]) << i;
+	}
+
+#endif
+}
+
+// build the structural index of a stream of the specified length
+void indexStructure(const char* str, const size_t len, StructuralIndex& index)
+{
+	const size_t words = (len + 63) / 64;
+
+	index.sep.resize(words);
+	index.nl.resize(words);
+	index.paren.resize(words);
+
+	size_t i = 0;
+	for (; i < len / 64; ++i)
+		indexBlock(str + i * 64, index.sep[i], index.nl[i], index.paren[i]);
+
+	// last partial block goes through a bounce buffer to avoid reading past the end of the stream
+	if (len % 64) {
+		char block[64] = {};
+		memcpy(block, str + i * 64, len % 64);
+		indexBlock(block, index.sep[i], index.nl[i], index.paren[i]);
+	}
+}
+
+// get the first non-separator location at or past the specified location; return stream length if none
+size_t StructuralIndex::getNextNonSeparator(const size_t pos, const size_t len) const
+{
+	assert(pos < len);
+
+	size_t w = pos / 64;
+	uint64_t word = ~sep[w] & uint64_t(-1) << pos % 64;
+
+	while (!word) {
+		if (++w == sep.size())
+			return len;
+
+		word = ~sep[w];
+	}
+
+	const size_t ret = w * 64 + __builtin_ctzll(word);
+	return ret < len ? ret : len;
+}
+
+// append the global offsets of all new-line locations to an ordered table, given the global offset of the stream
+void StructuralIndex::getNewLines(const uint32_t start, std::pmr::vector<uint32_t>& newlines) const
+{
+	for (size_t w = 0; w < nl.size(); ++w)
+		for (uint64_t word = nl[w]; word; word &= word - 1)
+			newlines.push_back(start + uint32_t(w * 64 + __builtin_ctzll(word)));
+}
+
+// get the count of payloads of the tokens before the specified one
+size_t TokenStream::rank(const size_t i) const
+{
+	assert(i < size());
+	return ranks[i / 64] + __builtin_popcountll(marks[i / 64] & ((uint64_t(1) << (i % 64)) - 1));
+}
+
+const TokenStream::Payload& TokenStream::getPayload(const size_t i) const
+{
+	assert(hasPayload(i));
+	assert(rank(i) < payloads.size());
+	return payloads[rank(i)];
+}
+
+const TokenStream::Span& TokenStream::getSpan(const uint32_t pos) const
+{
+	assert(!spans.empty());
+
+	// the latest span is the sole one of a batch source, and the one of most tokens of a stream
+	if (spans.back().start <= pos) {
+		assert(pos < spans.back().start + spans.back().len);
+		return spans.back();
+	}
+
+	size_t lo = 0;
+	size_t hi = spans.size();
+
+	// last span starting at or before the specified offset
+	while (1 < hi - lo) {
+		const size_t mid = (lo + hi) / 2;
+
+		if (spans[mid].start <= pos)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	assert(spans[lo].start <= pos && pos < spans[lo].start + spans[lo].len);
+	return spans[lo];
+}
+
+void TokenStream::getRowCol(const uint32_t pos, size_t& row, size_t& col) const
+{
+	// count of new-lines before the specified offset
+	size_t lo = 0;
+	size_t hi = newlines.size();
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2;
+
+		if (newlines[mid] < pos)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	row = rowBase + lo;
+	col = lo ? pos - newlines[lo - 1] - 1 : base + pos - lineStart;
+}
+
+size_t TokenStream::row(const size_t i) const
+{
+	size_t row, col;
+	getRowCol(offset[i], row, col);
+	return row;
+}
+
+size_t TokenStream::col(const size_t i) const
+{
+	size_t row, col;
+	getRowCol(offset[i], row, col);
+	return col;
+}
+
+StrRef TokenStream::val(const size_t i) const
+{
+	const Span& span = getSpan(offset[i]);
+	const char* const ptr = span.ptr + (offset[i] - span.start);
+	const Token t = token(i);
+
+	if (TOKEN_LITERAL_I32 <= t)
+		return StrRef{ .ptr = ptr, .len = getPayload(i).len };
+
+	assert(TOKEN_UNKNOWN != t && TOKEN_LITERAL_I32 > t);
+	return StrRef{ .ptr = ptr, .len = keywordTable.len[t - 1] };
+}
+
+// append a token, matching parentheses as they arrive
+void TokenStream::push(const Token t, const uint32_t pos)
+{
+	const size_t i = size();
+
+	kind.push_back(t);
+	offset.push_back(pos);
+
+	if (0 == i % 64) {
+		marks.push_back(0);
+		ranks.push_back(payloads.size());
+	}
+
+	// payloads of literals and identifiers are appended by the caller
+	if (TOKEN_LITERAL_I32 <= t || TOKEN_PARENTHESIS_L == t)
+		marks.back() |= uint64_t(1) << (i % 64);
+
+	if (TOKEN_PARENTHESIS_L == t) {
+		payloads.push_back(Payload{ .len = 1, .extent = 0 });
+		open.push_back(i);
+	}
+	else
+	if (TOKEN_PARENTHESIS_R == t) {
+		if (open.empty()) {
+			if (size_t(-1) == stray)
+				stray = i;
+		}
+		else {
+			payloads[rank(open.back())].extent = i - open.back() + 1;
+			open.pop_back();
+		}
+	}
+}
+
+// drop the specified count of leading tokens, along with their payloads, and any source spans and new-lines preceding the
+// remaining tokens, rebasing offsets to the earliest remaining span; unmatched parentheses must not be among those
+void TokenStream::erase(const size_t count)
+{
+	assert(count <= size());
+	assert(open.empty() || count <= open.front());
+	assert(size_t(-1) == stray || count <= stray);
+
+	for (std::pmr::vector<uint32_t>::iterator it = open.begin(); it != open.end(); ++it)
+		*it -= count;
+
+	if (size_t(-1) != stray)
+		stray -= count;
+
+	const uint32_t pos = count < size() ? offset[count] : end;
+	const size_t payloadCount = count < size() ? rank(count) : payloads.size();
+
+	// shift the bits of the remaining tokens down to the first word, recounting the ranks
+	const size_t words = (size() - count + 63) / 64;
+	const size_t skip = count / 64;
+	const size_t shift = count % 64;
+	uint32_t total = 0;
+
+	for (size_t w = 0; w < words; ++w) {
+		const uint64_t lo = marks[skip + w] >> shift;
+		const uint64_t hi = shift && skip + w + 1 < marks.size() ? marks[skip + w + 1] << (64 - shift) : 0;
+		marks[w] = lo | hi;
+		ranks[w] = total;
+		total += __builtin_popcountll(marks[w]);
+	}
+
+	marks.resize(words);
+	ranks.resize(words);
+
+	kind.erase(kind.begin(), kind.begin() + count);
+	offset.erase(offset.begin(), offset.begin() + count);
+	payloads.erase(payloads.begin(), payloads.begin() + payloadCount);
+
+	size_t spanCount = 0;
+
+	while (spanCount < spans.size() && spans[spanCount].start + spans[spanCount].len <= pos)
+		spanCount++;
+
+	size_t newlineCount = 0;
+
+	while (newlineCount < newlines.size() && newlines[newlineCount] < pos)
+		newlineCount++;
+
+	if (newlineCount) {
+		lineStart = base + newlines[newlineCount - 1] + 1;
+		rowBase += newlineCount;
+	}
+
+	const uint32_t rebase = spanCount < spans.size() ? spans[spanCount].start : end;
+
+	spans.erase(spans.begin(), spans.begin() + spanCount);
+	newlines.erase(newlines.begin(), newlines.begin() + newlineCount);
+
+	for (std::pmr::vector<uint32_t>::iterator it = offset.begin(); it != offset.end(); ++it)
+		*it -= rebase;
+
+	for (std::pmr::vector<Span>::iterator it = spans.begin(); it != spans.end(); ++it)
+		it->start -= rebase;
+
+	for (std::pmr::vector<uint32_t>::iterator it = newlines.begin(); it != newlines.end(); ++it)
+		*it -= rebase;
+
+	end -= rebase;
+	base += rebase;
+}
+
+void TokenStream::print(FILE* f, const size_t i) const
+{
+	const Token t = token(i);
+	const char* const stringToken = stringFromToken(t);
+	const StrRef v = val(i);
+	size_t row, col;
+	getRowCol(offset[i], row, col);
+
+	if (TOKEN_LITERAL_I32 == t) {
+		fprintf(f, "{\n\t"
+			"%s: %d\n\t"
+			"%p, %u\n\t"
+			"%zu, %zu\n}",
+			stringToken, literal_i32(i), v.ptr, v.len, row, col);
+	}
+	else
+	if (TOKEN_LITERAL_F32 == t) {
+		fprintf(f, "{\n\t"
+			"%s: %f\n\t"
+			"%p, %u\n\t"
+			"%zu, %zu\n}",
+			stringToken, literal_f32(i), v.ptr, v.len, row, col);
+	}
+	else
+	if (TOKEN_IDENTIFIER == t) {
+		fprintf(f, "{\n\t"
+			"%s: %.*s\n\t"
+			"%p, %u\n\t"
+			"%zu, %zu\n}",
+			stringToken, v.len, v.ptr, v.ptr, v.len, row, col);
+	}
+	else {
+		fprintf(f, "{\n\t"
+			"%s\n\t"
+			"%p, %u\n\t"
+			"%zu, %zu\n}",
+			stringToken, v.ptr, v.len, row, col);
+	}
+}
+
+// tokenize a stream of the specified length into tokens, appending the stream as a new source span to the token stream
+bool tokenize(
 	const char* str,
-	std::vector<TokenInStream>& tokens)
-{
-	uint32_t row = 0;
-	uint32_t col = 0;
-
-	while (!isTerminator(str)) {
-		const TriState sep = isSeparator(str);
-		if (sep) {
-			// at new-line advance row count and reset column count
-			if (TRI_PRIME == sep) {
-				row++;
-				col = uint32_t(-1);
-			}
-			col++;
-			str++;
+	const size_t len,
+	TokenStream& tokens)
+{
+	// offsets are 32-bit, relative to the earliest retained span
+	if (uint32_t(-1) - tokens.end < len) {
+		fprintf(stderr, "source too large\n");
+		return false;
+	}
+
+	const uint32_t start = tokens.end;
+	tokens.end += len;
+
+	if (len)
+		tokens.spans.push_back(TokenStream::Span{ .ptr = str, .start = start, .len = uint32_t(len) });
+
+	StructuralIndex index;
+	indexStructure(str, len, index);
+	index.getNewLines(start, tokens.newlines);
+
+	size_t pos = 0;
+
+	while (pos < len && !isTerminator(str + pos)) {
+		if (index.isSet(index.sep, pos)) {
+			// skip the entire separator run
+			pos = index.getNextNonSeparator(pos, len);
 			continue;
 		}
 
-		uint32_t tokenLen = 0;
+		uint32_t tokenLen = 1;
 		int32_t lit_i32 = 0;
 		float lit_f32 = 0;
-		const Token token = getToken(str, tokenLen, lit_i32, lit_f32);
+		Token token;
+
+		// parentheses are single-char keywords that never participate in other tokens
+		if (index.isSet(index.paren, pos))
+			token = '(' == str[pos] ? TOKEN_PARENTHESIS_L : TOKEN_PARENTHESIS_R;
+		else
+			token = getToken(str + pos, str + len, tokenLen, lit_i32, lit_f32);
 
 		if (TOKEN_UNKNOWN == token) {
-			fprintf(stderr, "syntax error at row, col: %u, %u\n", row, col);
+			size_t row, col;
+			tokens.getRowCol(start + pos, row, col);
+			fprintf(stderr, "syntax error at row, col: %zu, %zu\n", row, col);
 			return false;
 		}
 
+		tokens.push(token, start + pos);
+
 		if (TOKEN_LITERAL_F32 == token) {
-			const TokenInStream tis = { .val = { .ptr = str, .len = tokenLen }, .row = row, .col = col, .literal_f32 = lit_f32, .token = token };
-			tokens.push_back(tis);
+			const TokenStream::Payload payload = { .len = tokenLen, .literal_f32 = lit_f32 };
+			tokens.payloads.push_back(payload);
 		}
-		else {
-			const TokenInStream tis = { .val = { .ptr = str, .len = tokenLen }, .row = row, .col = col, .literal_i32 = lit_i32, .token = token };
-			tokens.push_back(tis);
+		else
+		if (TOKEN_LITERAL_I32 == token) {
+			const TokenStream::Payload payload = { .len = tokenLen, .literal_i32 = lit_i32 };
+			tokens.payloads.push_back(payload);
+		}
+		else
+		if (TOKEN_IDENTIFIER == token) {
+			const Symbol symbol = tokens.symbols.intern(StrRef{ .ptr = str + pos, .len = tokenLen });
+			const TokenStream::Payload payload = { .len = tokenLen, .symbol = symbol };
+			tokens.payloads.push_back(payload);
 		}
 
-		col += tokenLen;
-		str += tokenLen;
+		pos += tokenLen;
 	}
 
 	return true;
@@ -407,7 +1318,7 @@ bool tokenize(
 
 // Abstract Syntax Tree (AST)
 // AST node semantical types
-enum ASTNodeType : uint16_t {
+enum ASTNodeType : uint8_t {
 	ASTNODE_LET,         // expression that introduces named variables via a nested scope
 	ASTNODE_INIT,        // statement that initializes a single named variable; appears at the beginning of 'let' expressions
 	ASTNODE_EVAL_VAR,    // variable evaluation expression
@@ -437,7 +1348,7 @@ const char* stringFromNodeType(const ASTNodeType t)
 }
 
 // AST node return types
-enum ASTReturnType : uint16_t {
+enum ASTReturnType : uint8_t {
 	ASTRETURN_NONE,    // return type not established
 	ASTRETURN_I32,     // 32-bit signed integer
 	ASTRETURN_F32,     // 32-bit floating point
@@ -460,29 +1371,10 @@ const char* stringFromReturnType(const ASTReturnType t)
 	return "alien-return-type";
 }
 
-typedef size_t ASTNodeIndex; // index in ASTNodes
-typedef std::vector<ASTNodeIndex> ASTNodeIndices;
+typedef uint32_t ASTNodeIndex; // index in ASTNodes
 
 const ASTNodeIndex nullidx = ASTNodeIndex(-1);
 
-// AST node -- the equivalent of an expression or a statement in a (sub-) program
-struct ASTNode {
-	union {
-		StrRef  name;        // name of variable or function, AKA identifier
-		int32_t literal_i32; // value of integral literal
-		float   literal_f32; // value of floating-point literal
-	};
-	ASTReturnType  rtype;    // return type of node at evaluation
-	ASTNodeType    type;     // semantical type of node
-	ASTNodeIndex   parent;   // parent index
-	ASTNodeIndex   eval;     // eval semantics target
-	ASTNodeIndices args;     // per argument/sub-expression index
-
-	void print(FILE* f, const std::vector<ASTNode>& tree, const size_t depth) const;
-	bool isDefun() const { return ASTNODE_LET == type && name.ptr; }
-	bool isInitialize() const { return ASTNODE_INIT == type; }
-};
-
 // special eval targets for built-in functions, AKA intrinsics
 enum : ASTNodeIndex {
 	INTRIN_PLUS     = ASTNodeIndex(-2),
@@ -522,37 +1414,132 @@ ASTNodeIndex getEvalTarget(const Token token)
 	return nullidx;
 }
 
-void ASTNode::print(FILE* f, const std::vector<ASTNode>& tree, const size_t depth) const
+// get the keyword of an intrinsic eval target; keywords map to tokens by an offset of one
+const char* getIntrinsicName(const ASTNodeIndex eval)
+{
+	switch (eval) {
+	case INTRIN_PLUS:
+		return keywords[TOKEN_PLUS - 1];
+	case INTRIN_MINUS:
+		return keywords[TOKEN_MINUS - 1];
+	case INTRIN_MUL:
+		return keywords[TOKEN_MUL - 1];
+	case INTRIN_DIV:
+		return keywords[TOKEN_DIV - 1];
+	case INTRIN_IFZERO:
+		return keywords[TOKEN_IFZERO - 1];
+	case INTRIN_IFNEG:
+		return keywords[TOKEN_IFNEG - 1];
+	case INTRIN_PRINT:
+		return keywords[TOKEN_PRINT - 1];
+	case INTRIN_READ_I32:
+		return keywords[TOKEN_READ_I32 - 1];
+	case INTRIN_READ_F32:
+		return keywords[TOKEN_READ_F32 - 1];
+	}
+
+	return nullptr;
+}
+
+// AST node -- the equivalent of an expression or a statement in a (sub-) program; only the fields used by evaluation are kept
+// here, the rest are in ASTNodeInfo
+struct ASTNode {
+	union {
+		int32_t  literal_i32; // value of integral literal
+		float    literal_f32; // value of floating-point literal
+		uint32_t slot;        // position of var in the frame of its scope, for var inits and var evaluations
+	};
+	union {
+		ASTNodeIndex eval;    // eval semantics target, for function calls
+		uint32_t     depth;   // lexical depth of the scope introduced by node, for 'let' nodes; of the var scope for var evaluations
+	};
+	ASTNodeIndex  first = nullidx; // first argument/sub-expression index
+	ASTNodeIndex  next = nullidx;  // next sibling index
+	ASTNodeType   type : 8;        // semantical type of node
+	ASTReturnType rtype : 8;       // return type of node at evaluation
+	bool          defun;           // 'let' node is a defun statement
+
+	bool isDefun() const { return defun; }
+	bool isInitialize() const { return ASTNODE_INIT == type; }
+};
+
+static_assert(sizeof(ASTNode) == 20, "ASTNode is expected to be 20 bytes");
+
+// AST node info -- the fields of an AST node used by parsing and printing
+struct ASTNodeInfo {
+	Symbol       symbol;         // symbol of identifier, if any
+	ASTNodeIndex parent;         // parent index
+	ASTNodeIndex last = nullidx; // last argument/sub-expression index
+	ASTNodeIndex init = nullidx; // original 'init' statement, for var inits and var evaluations; replacement, for args of inlined calls
+};
+
+static_assert(sizeof(ASTNodeInfo) == 16, "ASTNodeInfo is expected to be 16 bytes");
+
+// AST -- node fields split in two parallel arrays by use, so that evaluation does not pull parsing-only fields into cache
+struct ASTNodes {
+	std::pmr::vector<ASTNode>     nodes;
+	std::pmr::vector<ASTNodeInfo> infos;
+
+	size_t size() const { return nodes.size(); }
+	ASTNode& operator[](const ASTNodeIndex i) { return nodes[i]; }
+	const ASTNode& operator[](const ASTNodeIndex i) const { return nodes[i]; }
+	ASTNodeInfo& info(const ASTNodeIndex i) { return infos[i]; }
+	const ASTNodeInfo& info(const ASTNodeIndex i) const { return infos[i]; }
+
+	ASTNodeIndex push(const ASTNode& node, const ASTNodeInfo& info);
+	void truncate(const ASTNodeIndex count) { nodes.resize(count); infos.resize(count); }
+	void print(FILE* f, const ASTNodeIndex index, const SymbolTable& symbols, const size_t depth) const;
+};
+
+// append a node to the tree; return its index
+ASTNodeIndex ASTNodes::push(const ASTNode& node, const ASTNodeInfo& info)
+{
+	// node indices must stay clear of the special eval targets
+	assert(nodes.size() < INTRIN_READ_F32);
+
+	nodes.push_back(node);
+	infos.push_back(info);
+	return ASTNodeIndex(nodes.size() - 1);
+}
+
+void ASTNodes::print(FILE* f, const ASTNodeIndex index, const SymbolTable& symbols, const size_t depth) const
 {
 	for (size_t i = 0; i < depth; ++i)
 		fprintf(f, "  ");
 
-	const char* const stringType = stringFromNodeType(type);
+	const ASTNode& node = nodes[index];
+	const ASTNodeInfo& info = infos[index];
+	const char* const stringType = stringFromNodeType(node.type);
+	StrRef name = { .ptr = nullptr, .len = 0 };
 
-	switch (type) {
+	if (nullsym != info.symbol)
+		name = symbols.getName(info.symbol);
+
+	switch (node.type) {
 	case ASTNODE_LET:
-		assert(name.ptr && name.len || !name.ptr && !name.len);
 		if (name.ptr)
-			fprintf(f, "%s: %s %.*s\n", stringType, stringFromReturnType(rtype), name.len, name.ptr);
+			fprintf(f, "%s: %s %.*s\n", stringType, stringFromReturnType(node.rtype), name.len, name.ptr);
 		else
-			fprintf(f, "%s: %s\n", stringType, stringFromReturnType(rtype));
+			fprintf(f, "%s: %s\n", stringType, stringFromReturnType(node.rtype));
 		break;
 	case ASTNODE_INIT:
 	case ASTNODE_EVAL_VAR:
 		assert(name.ptr && name.len);
-		fprintf(f, "%s: %s %.*s \033[38;5;13m(%lu)\033[0m\n", stringType, stringFromReturnType(rtype), name.len, name.ptr, eval);
+		fprintf(f, "%s: %s %.*s \033[38;5;13m(%u)\033[0m\n", stringType, stringFromReturnType(node.rtype), name.len, name.ptr, info.init);
 		break;
 	case ASTNODE_EVAL_FUN:
-		assert(name.ptr && name.len);
-		fprintf(f, "%s: %s %.*s\n", stringType, stringFromReturnType(rtype), name.len, name.ptr);
+		if (name.ptr)
+			fprintf(f, "%s: %s %.*s\n", stringType, stringFromReturnType(node.rtype), name.len, name.ptr);
+		else
+			fprintf(f, "%s: %s %s\n", stringType, stringFromReturnType(node.rtype), getIntrinsicName(node.eval));
 		break;
 	case ASTNODE_LITERAL:
-		switch (rtype) {
+		switch (node.rtype) {
 		case ASTRETURN_I32:
-			fprintf(f, "%s: %s %d\n", stringType, stringFromReturnType(rtype), literal_i32);
+			fprintf(f, "%s: %s %d\n", stringType, stringFromReturnType(node.rtype), node.literal_i32);
 			break;
 		case ASTRETURN_F32:
-			fprintf(f, "%s: %s %f\n", stringType, stringFromReturnType(rtype), literal_f32);
+			fprintf(f, "%s: %s %f\n", stringType, stringFromReturnType(node.rtype), node.literal_f32);
 			break;
 		default:
 			assert(false);
@@ -564,39 +1551,91 @@ void ASTNode::print(FILE* f, const std::vector<ASTNode>& tree, const size_t dept
 		break;
 	}
 
-	for (ASTNodeIndices::const_iterator it = args.begin(); it != args.end(); ++it)
-		tree[*it].print(f, tree, depth + 1);
+	// an init-statement shares its sub-node with the args of an inlined invocation, so sub-nodes end at the last one rather than at
+	// the end of the sibling list; an arg of an inlined invocation replaced by its eval is shown by its replacement
+	for (ASTNodeIndex it = node.first; nullidx != it; it = it == info.last ? nullidx : nodes[it].next) {
+		const bool replaced = ASTNODE_EVAL_FUN == nodes[it].type && index == infos[it].parent && nullidx != infos[it].init;
+		print(f, replaced ? infos[it].init : it, symbols, depth + 1);
+	}
+}
+
+// append a node to the arguments/sub-expressions of a parent node
+void appendChild(const ASTNodeIndex parent, const ASTNodeIndex child, ASTNodes& tree)
+{
+	assert(nullidx != parent && parent < tree.size());
+	assert(nullidx != child && child < tree.size());
+	assert(nullidx == tree[child].next);
+
+	if (nullidx == tree.info(parent).last)
+		tree[parent].first = child;
+	else
+		tree[tree.info(parent).last].next = child;
+
+	tree.info(parent).last = child;
+}
+
+// get the argument/sub-expression of a node at a given position; return -1 if no such
+ASTNodeIndex getChild(const ASTNodeIndex parent, size_t pos, const ASTNodes& tree)
+{
+	assert(nullidx != parent && parent < tree.size());
+	ASTNodeIndex it = tree[parent].first;
+
+	for (; nullidx != it && pos; it = tree[it].next, --pos) {}
+
+	return it;
 }
 
-typedef std::vector<ASTNode> ASTNodes;
+// get the number of arguments/sub-expressions of a node
+size_t getChildCount(const ASTNodeIndex parent, const ASTNodes& tree)
+{
+	assert(nullidx != parent && parent < tree.size());
+	size_t ret = 0;
+
+	for (ASTNodeIndex it = tree[parent].first; nullidx != it; it = tree[it].next)
+		ret++;
+
+	return ret;
+}
 
-// get the leading sub-span of matching left and right parenthesis in a token-stream span
+// get the leading sub-span of matching left and right parenthesis in a token-stream span; return -1 if not matched within the span
 size_t getMatchingParentheses(
-	const std::vector<TokenInStream>& tokens,
+	const TokenStream& tokens,
 	const size_t start,
 	const size_t len)
 {
-	assert(1 < len);
+	assert(len);
 	assert(start + len <= tokens.size());
-	assert(TOKEN_PARENTHESIS_L == tokens[start].token);
+	assert(TOKEN_PARENTHESIS_L == tokens.token(start));
 
-	unsigned depth = 0;
-	const std::vector<TokenInStream>::const_iterator begin = tokens.begin() + start + 1;
-	const std::vector<TokenInStream>::const_iterator end = tokens.begin() + start + len;
-	for (std::vector<TokenInStream>::const_iterator it = begin; it != end; ++it) {
-		if (TOKEN_PARENTHESIS_R == it->token) {
-			if (!depth)
-				return it - tokens.begin() - start + 1; // account for right parenthesis
-			depth--;
-		}
-		else
-		if (TOKEN_PARENTHESIS_L == it->token)
-			depth++;
-	}
+	// parentheses are matched at tokenization
+	const size_t span = tokens.extent(start);
+
+	if (span && span <= len)
+		return span;
 
 	return size_t(-1);
 }
 
+// check a token stream for unmatched parentheses, reporting the first stray right parenthesis, otherwise the outermost stray left one
+bool checkParentheses(const TokenStream& tokens)
+{
+	if (size_t(-1) != tokens.stray) {
+		fprintf(stderr, "stray right parentesis at line %zu, column %zu\n",
+			tokens.row(tokens.stray),
+			tokens.col(tokens.stray));
+		return false;
+	}
+
+	if (!tokens.open.empty()) {
+		fprintf(stderr, "stray left parentesis at line %zu, column %zu\n",
+			tokens.row(tokens.open.front()),
+			tokens.col(tokens.open.front()));
+		return false;
+	}
+
+	return true;
+}
+
 // get the number of sub-expressions or init statements to a given AST node; return init count if countInit is true, sub-expression count otherwise
 size_t getSubCount(
 	const bool countInit,
@@ -607,21 +1646,22 @@ size_t getSubCount(
 	const ASTNode& node = tree[parent];
 	assert(!countInit || ASTNODE_LET == node.type);
 
-	ASTNodeIndices::const_iterator it = node.args.begin();
+	ASTNodeIndex it = node.first;
+	size_t ret = 0;
 
 	// count leading 'init' statements
-	for (; it != node.args.end(); ++it)
-		if (ASTNODE_INIT != tree[*it].type)
+	for (; nullidx != it; it = tree[it].next, ++ret)
+		if (ASTNODE_INIT != tree[it].type)
 			break;
 
 	if (countInit)
-		return it - node.args.begin();
+		return ret;
 
 	// count trailing sub-expressions
-	size_t ret = 0;
-	for (; it != node.args.end(); ++it) {
+	ret = 0;
+	for (; nullidx != it; it = tree[it].next) {
 		// ignore 'defun' statements, i.e. named 'let' sub-nodes
-		if (tree[*it].isDefun())
+		if (tree[it].isDefun())
 			continue;
 
 		ret++;
@@ -630,107 +1670,78 @@ size_t getSubCount(
 	return ret;
 }
 
-size_t getNode(
-	const std::vector<TokenInStream>& tokens,
-	const size_t start,
-	const size_t len,
-	const ASTNodeIndex parent,
-	ASTNodes& tree);
+// lexical scope table of the parser -- the var init and the defun visible by each symbol at the current point of parsing; a binding
+// shadowed by an inner scope is logged for restoring at the completion of the inner scope
+struct ScopeTable {
+	struct Entry {
+		ASTNodeIndex node;  // 'init' statement or 'defun' statement; -1 if none
+		ASTNodeIndex scope; // 'let' node the binding belongs to; -1 if none
+	};
 
-// get the leading 'let' AST node in a token-stream span; return number of tokens encompassed; -1 if error
-size_t getNodeLet(
-	const std::vector<TokenInStream>& tokens,
-	const size_t start,
-	const size_t len,
-	const ASTNodeIndex parent,
-	ASTNodes& tree)
-{
-	assert(len);
-	assert(start + len <= tokens.size());
-	assert(TOKEN_PARENTHESIS_L == tokens[start].token);
+	struct Binding {
+		Symbol symbol;
+		bool   fun;  // binding is of a defun rather than of a var
+		Entry  prev; // binding of the symbol before this one
+	};
 
-	const size_t span = getMatchingParentheses(tokens, start, len);
+	std::pmr::vector<Entry>   vars; // per symbol, visible var
+	std::pmr::vector<Entry>   funs; // per symbol, visible defun
+	std::pmr::vector<Binding> log;  // bindings in order of introduction
 
-	// check for stray left parenthesis
-	if (size_t(-1) == span) {
-		fprintf(stderr, "invalid let at line %d, column %d\n",
-			tokens[start].row,
-			tokens[start].col);
-		return size_t(-1);
+	void reserve(const size_t symbolCount) {
+		const Entry none = { .node = nullidx, .scope = nullidx };
+		if (vars.size() <= symbolCount) {
+			vars.resize(symbolCount + 1, none);
+			funs.resize(symbolCount + 1, none);
+		}
 	}
+	void bind(const bool fun, const Symbol symbol, const ASTNodeIndex node, const ASTNodeIndex scope);
+	void unbind(const size_t mark);
+};
 
-	size_t start_it = start + 1; // account for left parenthesis
-	size_t span_it = span - 2; // account for both parentheses
+// make a var or a defun visible to the rest of the parse of a scope; of same-named vars or defuns in a scope the first one is visible
+void ScopeTable::bind(const bool fun, const Symbol symbol, const ASTNodeIndex node, const ASTNodeIndex scope)
+{
+	assert(nullsym != symbol && symbol < vars.size());
+	assert(nullidx != node && nullidx != scope);
+	Entry& entry = (fun ? funs : vars)[symbol];
 
-	// introduce named variables and initialize those
-	while (span_it) {
-		// check basic prerequisites of 'init' expression: (x expr)
-		if (4 > span_it || TOKEN_PARENTHESIS_L != tokens[start_it].token || TOKEN_IDENTIFIER != tokens[start_it + 1].token) {
-			fprintf(stderr, "invalid var-init at line %d, column %d\n",
-				tokens[start_it].row,
-				tokens[start_it].col);
-			return size_t(-1);
-		}
-
-		const size_t subspan = getMatchingParentheses(tokens, start_it, span_it);
-
-		// check for missing right parenthesis
-		if (size_t(-1) == subspan) {
-			fprintf(stderr, "invalid var-init at line %d, column %d\n",
-				tokens[start_it].row,
-				tokens[start_it].col);
-			return size_t(-1);
-		}
-
-		start_it += 1; // account for left parenthesis
-		span_it -= subspan;
-		size_t subspan_it = subspan - 2; // account for both parentheses
+	if (scope == entry.scope)
+		return;
 
-		ASTNode newnode = { .name = tokens[start_it].val, .rtype = ASTRETURN_NONE, .type = ASTNODE_INIT, .parent = parent, .eval = tree.size() };
-
-		const ASTNodeIndex newnodeIdx = tree.size();
-		tree.push_back(newnode);
-		tree[parent].args.push_back(newnodeIdx);
-
-		// account for identifier token itself
-		start_it++;
-		subspan_it--;
-
-		const size_t initspan = getNode(tokens, start_it, subspan_it, newnodeIdx, tree);
-
-		if (subspan_it != initspan) {
-			fprintf(stderr, "invalid var-init at line %d, column %d\n",
-				tokens[start_it].row,
-				tokens[start_it].col);
-			return size_t(-1);
-		}
+	log.push_back(Binding{ .symbol = symbol, .fun = fun, .prev = entry });
+	entry = Entry{ .node = node, .scope = scope };
+}
 
-		// update the return type of the init statement
-		tree[newnodeIdx].rtype = tree[tree[newnodeIdx].args.front()].rtype;
+// drop all bindings introduced after the given log size
+void ScopeTable::unbind(const size_t mark)
+{
+	assert(mark <= log.size());
 
-		start_it += initspan + 1; // account for right parenthesis
-		assert(subspan_it == initspan);
+	while (mark < log.size()) {
+		const Binding& binding = log.back();
+		(binding.fun ? funs : vars)[binding.symbol] = binding.prev;
+		log.pop_back();
 	}
-
-	return span;
 }
 
 // get the leading 'defun' AST node in a token-stream span; return number of tokens encompassed; -1 if error
 size_t getNodeDefun(
-	const std::vector<TokenInStream>& tokens,
+	const TokenStream& tokens,
 	const size_t start,
 	const size_t len,
 	const ASTNodeIndex parent,
-	ASTNodes& tree)
+	ASTNodes& tree,
+	ScopeTable& scopes)
 {
 	assert(1 < len);
 	assert(start + len <= tokens.size());
-	assert(TOKEN_IDENTIFIER == tokens[start].token);
+	assert(TOKEN_IDENTIFIER == tokens.token(start));
 
-	if (TOKEN_PARENTHESIS_L != tokens[start + 1].token) {
-		fprintf(stderr, "invalid defun at line %d, column %d\n",
-			tokens[start].row,
-			tokens[start].col);
+	if (TOKEN_PARENTHESIS_L != tokens.token(start + 1)) {
+		fprintf(stderr, "invalid defun at line %zu, column %zu\n",
+			tokens.row(start),
+			tokens.col(start));
 		return size_t(-1);
 	}
 
@@ -741,30 +1752,31 @@ size_t getNodeDefun(
 
 	// check for stray left parenthesis
 	if (size_t(-1) == span) {
-		fprintf(stderr, "invalid defun at line %d, column %d\n",
-			tokens[start_it].row,
-			tokens[start_it].col);
+		fprintf(stderr, "invalid defun at line %zu, column %zu\n",
+			tokens.row(start_it),
+			tokens.col(start_it));
 		return size_t(-1);
 	}
 
 	start_it++; // account for left parenthesis
 	span_it = span - 2; // account for both parentheses
 
-	// introduce named variables but don't initialize those
+	// introduce named variables but don't initialize those; args are visible throughout the defun
 	while (span_it) {
 		// check basic prerequisites of 'defun' version of 'init' expression: x
-		if (TOKEN_IDENTIFIER != tokens[start_it].token) {
-			fprintf(stderr, "invalid defun-arg at line %d, column %d\n",
-				tokens[start_it].row,
-				tokens[start_it].col);
+		if (TOKEN_IDENTIFIER != tokens.token(start_it)) {
+			fprintf(stderr, "invalid defun-arg at line %zu, column %zu\n",
+				tokens.row(start_it),
+				tokens.col(start_it));
 			return size_t(-1);
 		}
 
-		ASTNode newnode = { .name = tokens[start_it].val, .rtype = ASTRETURN_UNKNOWN, .type = ASTNODE_INIT, .parent = parent, .eval = tree.size() };
+		const ASTNode newnode = { .slot = nullidx == tree.info(parent).last ? 0 : tree[tree.info(parent).last].slot + 1, .type = ASTNODE_INIT, .rtype = ASTRETURN_UNKNOWN };
+		const ASTNodeInfo newinfo = { .symbol = tokens.symbol(start_it), .parent = parent, .init = ASTNodeIndex(tree.size()) };
 
-		const ASTNodeIndex newnodeIdx = tree.size();
-		tree.push_back(newnode);
-		tree[parent].args.push_back(newnodeIdx);
+		const ASTNodeIndex newnodeIdx = tree.push(newnode, newinfo);
+		appendChild(parent, newnodeIdx, tree);
+		scopes.bind(false, newinfo.symbol, newnodeIdx, parent);
 
 		// account for identifier token itself
 		start_it++;
@@ -774,75 +1786,6 @@ size_t getNodeDefun(
 	return span + 1; // account for identifier
 }
 
-// return the index of the 'init' statement of a named var; -1 if not found
-ASTNodeIndex checkKnownVar(
-	const StrRef& name,
-	ASTNodeIndex parent,
-	const ASTNodes& tree)
-{
-	assert(name.ptr);
-	assert(name.len);
-
-	if (nullidx == parent)
-		return nullidx;
-
-	assert(parent < tree.size());
-
-	// if parent node is an init-statement then backtrack out of its parent let-expression, avoiding
-	// matches to siblings originating from the same let-expression
-	if (ASTNODE_INIT == tree[parent].type) {
-		parent = tree[parent].parent;
-		assert(nullidx != parent && parent < tree.size());
-		assert(ASTNODE_LET == tree[parent].type);
-		parent = tree[parent].parent;
-		assert(nullidx != parent && parent < tree.size());
-	}
-
-	if (ASTNODE_LET == tree[parent].type) {
-		for (ASTNodeIndices::const_iterator it = tree[parent].args.begin(); it != tree[parent].args.end(); ++it) {
-			// only the leading subnodes of a 'let' expression are 'init' statements
-			if (ASTNODE_INIT != tree[*it].type)
-				break;
-
-			if (name.len == tree[*it].name.len && 0 == strncmp(tree[*it].name.ptr, name.ptr, name.len))
-				return *it;
-		}
-	}
-
-	return checkKnownVar(name, tree[parent].parent, tree);
-}
-
-ASTNodeIndex checkKnownDefun(
-	const StrRef& name,
-	const ASTNodeIndex parent,
-	const ASTNodes& tree)
-{
-	assert(name.ptr);
-	assert(name.len);
-
-	if (nullidx == parent)
-		return nullidx;
-
-	assert(parent < tree.size());
-
-	// check all parent and grand-parent let-expressions and defun-statements
-	if (ASTNODE_LET == tree[parent].type) {
-		if (name.len == tree[parent].name.len && 0 == strncmp(tree[parent].name.ptr, name.ptr, name.len))
-			return parent;
-
-		// check all defun-sub-nodes of this (grand) parent
-		for (ASTNodeIndices::const_iterator it = tree[parent].args.begin(); it != tree[parent].args.end(); ++it) {
-			if (ASTNODE_LET != tree[*it].type)
-				continue;
-
-			if (name.len == tree[*it].name.len && 0 == strncmp(tree[*it].name.ptr, name.ptr, name.len))
-				return *it;
-		}
-	}
-
-	return checkKnownDefun(name, tree[parent].parent, tree);
-}
-
 const ssize_t max_ssize = size_t(-1) >> 1;
 
 // return the promoted type of the args to an arithmetic expression; rules of promotion follow the enum order
@@ -854,15 +1797,15 @@ ASTReturnType getArgsReturnType(
 	const ASTNode& node = tree[parent];
 	assert(ASTNODE_EVAL_FUN == node.type);
 
-	if (node.args.empty())
+	if (nullidx == node.first)
 		return ASTRETURN_NONE;
 
-	ASTReturnType ret = tree[node.args.front()].rtype;
+	ASTReturnType ret = tree[node.first].rtype;
 
 	// shortcut: stop iterating the args as soon as max promotion level is reached
-	for (ASTNodeIndices::const_iterator it = node.args.begin() + 1; it != node.args.end() && ASTRETURN_UNKNOWN != ret; ++it) {
-		if (ret < tree[*it].rtype) {
-			ret = tree[*it].rtype;
+	for (ASTNodeIndex it = tree[node.first].next; nullidx != it && ASTRETURN_UNKNOWN != ret; it = tree[it].next) {
+		if (ret < tree[it].rtype) {
+			ret = tree[it].rtype;
 		}
 	}
 
@@ -875,15 +1818,14 @@ ASTReturnType getIfReturnType(
 	const ASTNodes& tree)
 {
 	assert(nullidx != parent && parent < tree.size());
-	const ASTNode& node = tree[parent];
-	assert(ASTNODE_EVAL_FUN == node.type);
+	assert(ASTNODE_EVAL_FUN == tree[parent].type);
 
-	if (3 != node.args.size())
+	if (3 != getChildCount(parent, tree))
 		return ASTRETURN_NONE;
 
-	ASTReturnType ret = tree[node.args[1]].rtype;
+	ASTReturnType ret = tree[getChild(parent, 1, tree)].rtype;
 
-	if (tree[node.args[2]].rtype != ret)
+	if (tree[tree.info(parent).last].rtype != ret)
 		ret = ASTRETURN_UNKNOWN;
 
 	return ret;
@@ -893,7 +1835,8 @@ ASTReturnType getIfReturnType(
 // if no such known function, return max ssize_t; if a function is found, update the return type of the invocation to the one of the function
 ssize_t getMinFunArgs(
 	const ASTNodeIndex parent,
-	ASTNodes& tree)
+	ASTNodes& tree,
+	const ScopeTable& scopes)
 {
 	assert(nullidx != parent && parent < tree.size());
 	ASTNode& node = tree[parent];
@@ -914,7 +1857,7 @@ ssize_t getMinFunArgs(
 		node.rtype = getIfReturnType(parent, tree);
 		return 3;
 	case INTRIN_PRINT:
-		node.rtype = tree[node.args.front()].rtype;
+		node.rtype = tree[node.first].rtype;
 		return 1;
 	case INTRIN_READ_I32:
 		node.rtype = ASTRETURN_I32;
@@ -924,8 +1867,8 @@ ssize_t getMinFunArgs(
 		return 0;
 	}
 
-	// check the upper tree for a matching defun; at a match an exact number of args is returned
-	const ASTNodeIndex defunIdx = checkKnownDefun(node.name, node.parent, tree);
+	// check the enclosing scopes for a matching defun; at a match an exact number of args is returned
+	const ASTNodeIndex defunIdx = scopes.funs[tree.info(parent).symbol].node;
 
 	if (nullidx == defunIdx)
 		return max_ssize;
@@ -936,68 +1879,100 @@ ssize_t getMinFunArgs(
 	return getSubCount(true, defunIdx, tree);
 }
 
-// get the leading AST node in a token-stream span; return number of tokens encompassed; -1 if error
-size_t getNode(
-	const std::vector<TokenInStream>& tokens,
+// pending parenthesized AST node of the parser; nodes are parsed via an explicit stack of those, rather than via recursion,
+// so that nesting depth is limited only by memory
+struct ParseFrame {
+	enum State : uint8_t {
+		PARSE_INITS,    // introducing the named vars of a 'let' expression
+		PARSE_INIT_EXPR,// awaiting the expression of a var-init
+		PARSE_BODY      // awaiting sub-expressions
+	};
+
+	State        state;
+	ASTNodeIndex node;     // node being populated
+	size_t       start;    // left parenthesis of node
+	size_t       span;     // count of tokens encompassed by node
+	size_t       start_it; // next sub-expression of node
+	size_t       span_it;  // count of tokens remaining in node
+	size_t       list_it;  // next var-init of a 'let' expression, or expression of a var-init
+	size_t       listspan; // count of tokens encompassed by the var-init list of a 'let' expression
+	size_t       listspan_it;    // count of tokens remaining in the var-init list
+	size_t       initspan_it;    // count of tokens of the expression of a var-init
+	ASTNodeIndex init;           // var-init being populated
+	size_t       mark;           // scope-table log size to restore at completion of node
+	uint32_t     depth;          // lexical depth of the innermost scope of sub-nodes
+};
+
+const size_t parse_pending = size_t(-2);
+
+// start the leading AST node in a token-stream span; return number of tokens encompassed if the node is complete, parse_pending
+// if a parenthesized node was pushed on the parse stack, and -1 if error
+size_t beginNode(
+	const TokenStream& tokens,
 	const size_t start,
 	const size_t len,
 	const ASTNodeIndex parent,
-	ASTNodes& tree)
+	const uint32_t depth,
+	ASTNodes& tree,
+	ScopeTable& scopes,
+	std::pmr::vector<ParseFrame>& frames)
 {
 	assert(len);
 	assert(start + len <= tokens.size());
 	assert(nullidx != parent && parent < tree.size());
 
 	// check for stray right parenthesis
-	if (TOKEN_PARENTHESIS_R == tokens[start].token) {
-		fprintf(stderr, "stray right parentesis at line %d, column %d\n",
-			tokens[start].row,
-			tokens[start].col);
+	if (TOKEN_PARENTHESIS_R == tokens.token(start)) {
+		fprintf(stderr, "stray right parentesis at line %zu, column %zu\n",
+			tokens.row(start),
+			tokens.col(start));
 		return size_t(-1);
 	}
 
-	ASTNode newnode = { .parent = parent };
+	ASTNode newnode = {};
+	ASTNodeInfo newinfo = { .parent = parent };
 	const ASTNodeIndex newnodeIdx = tree.size();
 
 	// check for parenthesized expressions like function calls and scopes
-	if (TOKEN_PARENTHESIS_L == tokens[start].token) {
+	if (TOKEN_PARENTHESIS_L == tokens.token(start)) {
 		const size_t span = getMatchingParentheses(tokens, start, len);
 
 		// check for stray left parenthesis
 		if (size_t(-1) == span) {
-			fprintf(stderr, "stray left parentesis at line %d, column %d\n",
-				tokens[start].row,
-				tokens[start].col);
+			fprintf(stderr, "stray left parentesis at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
 			return size_t(-1);
 		}
 
 		// check for empty expression
 		if (2 == span) {
-			fprintf(stderr, "empty parenteses at line %d, column %d\n",
-				tokens[start].row,
-				tokens[start].col);
+			fprintf(stderr, "empty parenteses at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
 			return size_t(-1);
 		}
 
+		ParseFrame frame = { .state = ParseFrame::PARSE_BODY, .node = newnodeIdx, .start = start, .span = span, .mark = scopes.log.size(), .depth = depth };
 		size_t start_it = start + 1; // account for left parenthesis
 		size_t span_it = span - 2; // account for both parentheses
 
-		switch (tokens[start_it].token) {
+		switch (tokens.token(start_it)) {
 			size_t subspan;
 		case TOKEN_DEFUN:
 			// 'defun' statements are disallowed anywhere but in 'let' expressions for better lisp-ness
 			if (ASTNODE_LET != tree[parent].type) {
-				fprintf(stderr, "misplaced defun at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
+				fprintf(stderr, "misplaced defun at line %zu, column %zu\n",
+					tokens.row(start),
+					tokens.col(start));
 				return size_t(-1);
 			}
 
 			// check basic prerequisites of 'defun' statement: defun f() expr
-			if (5 > span_it || TOKEN_IDENTIFIER != tokens[start_it + 1].token) {
-				fprintf(stderr, "invalid defun at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
+			if (5 > span_it || TOKEN_IDENTIFIER != tokens.token(start_it + 1)) {
+				fprintf(stderr, "invalid defun at line %zu, column %zu\n",
+					tokens.row(start),
+					tokens.col(start));
 				return size_t(-1);
 			}
 
@@ -1006,15 +1981,22 @@ size_t getNode(
 			span_it--;
 
 			// node introduces a named scope
-			newnode.name = tokens[start_it].val;
+			newnode.depth = ++frame.depth;
 			newnode.rtype = ASTRETURN_UNKNOWN;
 			newnode.type = ASTNODE_LET;
+			newnode.defun = true;
+			newinfo.symbol = tokens.symbol(start_it);
+
+			tree.push(newnode, newinfo);
+			appendChild(parent, newnodeIdx, tree);
 
-			tree.push_back(newnode);
-			tree[parent].args.push_back(newnodeIdx);
+			// defun is visible in the parent scope past its completion, and in its own scope ahead of any same-named sub-defun
+			scopes.bind(true, newinfo.symbol, newnodeIdx, parent);
+			frame.mark = scopes.log.size();
+			scopes.bind(true, newinfo.symbol, newnodeIdx, newnodeIdx);
 
 			// introduce named args into their dedicated scope
-			subspan = getNodeDefun(tokens, start_it, span_it, newnodeIdx, tree);
+			subspan = getNodeDefun(tokens, start_it, span_it, newnodeIdx, tree, scopes);
 
 			if (size_t(-1) == subspan)
 				return size_t(-1);
@@ -1025,34 +2007,41 @@ size_t getNode(
 
 		case TOKEN_LET:
 			// check basic prerequisites of 'let' expression: let () expr
-			if (4 > span_it || TOKEN_PARENTHESIS_L != tokens[start_it + 1].token) {
-				fprintf(stderr, "invalid let at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
+			if (4 > span_it || TOKEN_PARENTHESIS_L != tokens.token(start_it + 1)) {
+				fprintf(stderr, "invalid let at line %zu, column %zu\n",
+					tokens.row(start),
+					tokens.col(start));
 				return size_t(-1);
 			}
 
 			// node introduces an anonymous scope
-			newnode.name.ptr = nullptr;
-			newnode.name.len = 0;
+			newnode.depth = ++frame.depth;
 			newnode.rtype = ASTRETURN_NONE;
 			newnode.type = ASTNODE_LET;
+			newinfo.symbol = nullsym;
 
-			tree.push_back(newnode);
-			tree[parent].args.push_back(newnodeIdx);
+			tree.push(newnode, newinfo);
+			appendChild(parent, newnodeIdx, tree);
 
 			// account for keyword token itself
 			start_it++;
 			span_it--;
 
 			// introduce named vars into their dedicated scope
-			subspan = getNodeLet(tokens, start_it, span_it, newnodeIdx, tree);
+			subspan = getMatchingParentheses(tokens, start_it, span_it);
 
-			if (size_t(-1) == subspan)
+			// check for stray left parenthesis
+			if (size_t(-1) == subspan) {
+				fprintf(stderr, "invalid let at line %zu, column %zu\n",
+					tokens.row(start_it),
+					tokens.col(start_it));
 				return size_t(-1);
+			}
 
-			start_it += subspan;
-			span_it -= subspan;
+			frame.state = ParseFrame::PARSE_INITS;
+			frame.list_it = start_it + 1; // account for left parenthesis
+			frame.listspan = subspan;
+			frame.listspan_it = subspan - 2; // account for both parentheses
 			break;
 
 		// check for various function calls
@@ -1066,13 +2055,13 @@ size_t getNode(
 		case TOKEN_READ_I32:
 		case TOKEN_READ_F32:
 		case TOKEN_IDENTIFIER:
-			newnode.name = tokens[start_it].val;
+			newnode.eval = getEvalTarget(tokens.token(start_it));
 			newnode.rtype = ASTRETURN_NONE;
 			newnode.type = ASTNODE_EVAL_FUN;
-			newnode.eval = getEvalTarget(tokens[start_it].token);
+			newinfo.symbol = TOKEN_IDENTIFIER == tokens.token(start_it) ? tokens.symbol(start_it) : nullsym;
 
-			tree.push_back(newnode);
-			tree[parent].args.push_back(newnodeIdx);
+			tree.push(newnode, newinfo);
+			appendChild(parent, newnodeIdx, tree);
 
 			// account for keyword/identifier token itself
 			start_it++;
@@ -1080,121 +2069,268 @@ size_t getNode(
 			break;
 
 		default:
-			fprintf(stderr, "unexpected token at line %d, column %d\n",
-				tokens[start].row,
-				tokens[start].col);
+			fprintf(stderr, "unexpected token at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
 			return size_t(-1);
 		}
 
-		// check for a sub-expression sequence
-		while (span_it) {
-			const size_t subspan = getNode(tokens, start_it, span_it, newnodeIdx, tree);
-
-			if (size_t(-1) == subspan)
-				return size_t(-1);
-
-			start_it += subspan;
-			span_it -= subspan;
-		}
-
-		// verify correct number of sub-expressions for the given expression
-		ASTNodeIndices::const_reverse_iterator it;
-		switch (tree[newnodeIdx].type) {
-			size_t subcount;
-			ssize_t funargs;
-		case ASTNODE_LET:
-			// 'let' nodes, whether let-expressions or defun-statements, need at least one expression to return
-			subcount = getSubCount(false, newnodeIdx, tree);
-			if (0 == subcount) {
-				fprintf(stderr, "invalid let/defun at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
-				return size_t(-1);
-			}
-			// return type copied from last sub-expression
-			for (it = tree[newnodeIdx].args.rbegin(); it != tree[newnodeIdx].args.rend() && tree[*it].isDefun(); ++it) {}
-			tree[newnodeIdx].rtype = tree[*it].rtype;
-			break;
-		case ASTNODE_EVAL_FUN:
-			subcount = getSubCount(false, newnodeIdx, tree);
-			funargs = getMinFunArgs(newnodeIdx, tree);
-
-			// check if referenced function exists
-			if (max_ssize == funargs) {
-				fprintf(stderr, "unknown function call at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
-				return size_t(-1);
-			}
-
-			// non-negative funargs means exact count, negative -- minimal count
-			if (0 <= funargs ? subcount != funargs : subcount < -funargs) {
-				fprintf(stderr, "invalid function call at line %d, column %d\n",
-					tokens[start].row,
-					tokens[start].col);
-				return size_t(-1);
-			}
-			break;
-		default:
-			break;
-		}
-
-		return span;
+		frame.start_it = start_it;
+		frame.span_it = span_it;
+		frames.push_back(frame);
+		return parse_pending;
 	}
 
 	// check for various single-token nodes
-	switch (tokens[start].token) {
+	switch (tokens.token(start)) {
 		ASTNodeIndex initIdx;
 	case TOKEN_LITERAL_I32:
-		newnode.literal_i32 = tokens[start].literal_i32;
+		newnode.literal_i32 = tokens.literal_i32(start);
 		newnode.rtype = ASTRETURN_I32;
 		newnode.type = ASTNODE_LITERAL;
 		break;
 
 	case TOKEN_LITERAL_F32:
-		newnode.literal_f32 = tokens[start].literal_f32;
+		newnode.literal_f32 = tokens.literal_f32(start);
 		newnode.rtype = ASTRETURN_F32;
 		newnode.type = ASTNODE_LITERAL;
 		break;
 
 	case TOKEN_IDENTIFIER:
 		// check against known var identifiers
-		initIdx = checkKnownVar(tokens[start].val, parent, tree);
+		initIdx = scopes.vars[tokens.symbol(start)].node;
 
 		if (nullidx == initIdx) {
-			fprintf(stderr, "unknown var at line %d, column %d\n",
-				tokens[start].row,
-				tokens[start].col);
+			fprintf(stderr, "unknown var at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
 			return size_t(-1);
 		}
 
-		newnode.name = tokens[start].val;
+		newnode.slot = tree[initIdx].slot;
+		newnode.depth = tree[tree.info(initIdx).parent].depth;
 		newnode.rtype = tree[initIdx].rtype;
 		newnode.type = ASTNODE_EVAL_VAR;
-		newnode.eval = initIdx;
+		newinfo.symbol = tokens.symbol(start);
+		newinfo.init = initIdx;
 		break;
 
 	default:
-		fprintf(stderr, "unexpected token at line %d, column %d\n",
-			tokens[start].row,
-			tokens[start].col);
+		fprintf(stderr, "unexpected token at line %zu, column %zu\n",
+			tokens.row(start),
+			tokens.col(start));
 		return size_t(-1);
 	}
 
-	tree.push_back(newnode);
-	tree[parent].args.push_back(newnodeIdx);
+	tree.push(newnode, newinfo);
+	appendChild(parent, newnodeIdx, tree);
 
 	return 1;
 }
 
+// complete a parenthesized AST node whose sub-expressions are all parsed; return number of tokens encompassed; -1 if error
+size_t endNode(
+	const TokenStream& tokens,
+	const ParseFrame& frame,
+	ASTNodes& tree,
+	const ScopeTable& scopes)
+{
+	const ASTNodeIndex newnodeIdx = frame.node;
+	const size_t start = frame.start;
+
+	// verify correct number of sub-expressions for the given expression
+	switch (tree[newnodeIdx].type) {
+		size_t subcount;
+		ssize_t funargs;
+		ASTNodeIndex retIdx;
+	case ASTNODE_LET:
+		// 'let' nodes, whether let-expressions or defun-statements, need at least one expression to return
+		subcount = getSubCount(false, newnodeIdx, tree);
+		if (0 == subcount) {
+			fprintf(stderr, "invalid let/defun at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
+			return size_t(-1);
+		}
+		// return type copied from last sub-expression
+		retIdx = nullidx;
+		for (ASTNodeIndex it = tree[newnodeIdx].first; nullidx != it; it = tree[it].next)
+			if (!tree[it].isDefun())
+				retIdx = it;
+		tree[newnodeIdx].rtype = tree[retIdx].rtype;
+		break;
+	case ASTNODE_EVAL_FUN:
+		subcount = getSubCount(false, newnodeIdx, tree);
+		funargs = getMinFunArgs(newnodeIdx, tree, scopes);
+
+		// check if referenced function exists
+		if (max_ssize == funargs) {
+			fprintf(stderr, "unknown function call at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
+			return size_t(-1);
+		}
+
+		// non-negative funargs means exact count, negative -- minimal count
+		if (0 <= funargs ? subcount != funargs : subcount < -funargs) {
+			fprintf(stderr, "invalid function call at line %zu, column %zu\n",
+				tokens.row(start),
+				tokens.col(start));
+			return size_t(-1);
+		}
+		break;
+	default:
+		break;
+	}
+
+	return frame.span;
+}
+
+// get the leading AST node in a token-stream span; return number of tokens encompassed; -1 if error
+size_t getNode(
+	const TokenStream& tokens,
+	const size_t start,
+	const size_t len,
+	const ASTNodeIndex parent,
+	ASTNodes& tree,
+	ScopeTable& scopes,
+	std::pmr::vector<ParseFrame>& frames)
+{
+	const size_t mark = scopes.log.size();
+	scopes.reserve(tokens.symbols.names.size());
+
+	assert(ASTNODE_LET == tree[parent].type);
+	assert(frames.empty());
+
+	size_t span = beginNode(tokens, start, len, parent, tree[parent].depth, tree, scopes, frames);
+
+	// each iteration either starts a sub-node of the top frame, or hands over to the top frame the span of a completed sub-node;
+	// a newly-pushed frame starts with a zero span
+	while (!frames.empty()) {
+		if (parse_pending == span)
+			span = 0;
+
+		if (size_t(-1) == span) {
+			// a failed var-init expression fails its var-init as well, all the way up the stack
+			for (std::pmr::vector<ParseFrame>::const_reverse_iterator it = frames.rbegin(); it != frames.rend(); ++it)
+				if (ParseFrame::PARSE_INIT_EXPR == it->state)
+					fprintf(stderr, "invalid var-init at line %zu, column %zu\n",
+						tokens.row(it->list_it),
+						tokens.col(it->list_it));
+
+			frames.clear();
+			scopes.unbind(mark);
+			return size_t(-1);
+		}
+
+		ParseFrame& frame = frames.back();
+
+		switch (frame.state) {
+			size_t subspan;
+		case ParseFrame::PARSE_INITS:
+			if (!frame.listspan_it) {
+				// done with var-inits; make them visible to the sub-expressions and continue with those
+				for (ASTNodeIndex it = tree[frame.node].first; nullidx != it; it = tree[it].next)
+					scopes.bind(false, tree.info(it).symbol, it, frame.node);
+
+				frame.state = ParseFrame::PARSE_BODY;
+				span = frame.listspan;
+				break;
+			}
+
+			// check basic prerequisites of 'init' expression: (x expr)
+			if (4 > frame.listspan_it || TOKEN_PARENTHESIS_L != tokens.token(frame.list_it) || TOKEN_IDENTIFIER != tokens.token(frame.list_it + 1)) {
+				fprintf(stderr, "invalid var-init at line %zu, column %zu\n",
+					tokens.row(frame.list_it),
+					tokens.col(frame.list_it));
+				span = size_t(-1);
+				break;
+			}
+
+			subspan = getMatchingParentheses(tokens, frame.list_it, frame.listspan_it);
+
+			// check for missing right parenthesis
+			if (size_t(-1) == subspan) {
+				fprintf(stderr, "invalid var-init at line %zu, column %zu\n",
+					tokens.row(frame.list_it),
+					tokens.col(frame.list_it));
+				span = size_t(-1);
+				break;
+			}
+
+			frame.list_it += 1; // account for left parenthesis
+			frame.listspan_it -= subspan;
+			frame.initspan_it = subspan - 2; // account for both parentheses
+
+			{
+				const ASTNode newnode = { .slot = nullidx == tree.info(frame.node).last ? 0 : tree[tree.info(frame.node).last].slot + 1, .type = ASTNODE_INIT, .rtype = ASTRETURN_NONE };
+				const ASTNodeInfo newinfo = { .symbol = tokens.symbol(frame.list_it), .parent = frame.node, .init = ASTNodeIndex(tree.size()) };
+
+				frame.init = tree.push(newnode, newinfo);
+				appendChild(frame.node, frame.init, tree);
+			}
+
+			// account for identifier token itself
+			frame.list_it++;
+			frame.initspan_it--;
+			frame.state = ParseFrame::PARSE_INIT_EXPR;
+
+			// check for missing expression
+			if (!frame.initspan_it) {
+				span = size_t(-1);
+				break;
+			}
+
+			// frame is invalidated by the push of a sub-node frame
+			span = beginNode(tokens, frame.list_it, frame.initspan_it, frame.init, frame.depth, tree, scopes, frames);
+			break;
+
+		case ParseFrame::PARSE_INIT_EXPR:
+			if (frame.initspan_it != span) {
+				fprintf(stderr, "invalid var-init at line %zu, column %zu\n",
+					tokens.row(frame.list_it),
+					tokens.col(frame.list_it));
+				frame.state = ParseFrame::PARSE_INITS;
+				span = size_t(-1);
+				break;
+			}
+
+			// update the return type of the init statement
+			tree[frame.init].rtype = tree[tree[frame.init].first].rtype;
+
+			frame.list_it += span + 1; // account for right parenthesis
+			frame.state = ParseFrame::PARSE_INITS;
+			span = 0;
+			break;
+
+		case ParseFrame::PARSE_BODY:
+			frame.start_it += span;
+			frame.span_it -= span;
+
+			// check for a sub-expression sequence
+			if (frame.span_it) {
+				// frame is invalidated by the push of a sub-node frame
+				span = beginNode(tokens, frame.start_it, frame.span_it, frame.node, frame.depth, tree, scopes, frames);
+				break;
+			}
+
+			span = endNode(tokens, frame, tree, scopes);
+			scopes.unbind(frame.mark);
+			frames.pop_back();
+			break;
+		}
+	}
+
+	return span;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // evaluation of (guaranteed correct) AST
 
+// value of evaluation -- a type tag of a byte of its own and a payload, so that type tests are plain compares and the whole fits in a
+// register; statuses of partial evaluation are kept apart, in PEValue
 struct Value {
-	ASTReturnType type : 13;
-	bool literal : 1;
-	bool sidefx : 1;
-	bool incoh : 1;
+	ASTReturnType type;
 	union {
 		int32_t i32;
 		float f32;
@@ -1203,21 +2339,21 @@ struct Value {
 	void print(FILE* f) const;
 };
 
+static_assert(sizeof(Value) == 8, "Value is expected to be 8 bytes");
+
+// value of partial evaluation -- a value along with its statuses: of literals only, of side effects along the way, of a type up to
+// the branch taken by an 'if'
+struct PEValue {
+	Value value;
+	bool  literal;
+	bool  sidefx;
+	bool  incoh;
+};
+
 void Value::print(FILE* f) const
 {
 	fprintf(f, "%s", stringFromReturnType(type));
 
-#if 0
-	if (literal)
-		fprintf(f, " \033[38;5;14m" "lit" "\033[0m");
-
-	if (sidefx)
-		fprintf(f, " \033[38;5;11m" "sid" "\033[0m");
-
-	if (incoh)
-		fprintf(f, " \033[38;5;9m" "inc" "\033[0m");
-
-#endif
 	switch (type) {
 	case ASTRETURN_I32:
 		fprintf(f, " %d\n", i32);
@@ -1231,17 +2367,220 @@ void Value::print(FILE* f) const
 	}
 }
 
-struct NamedValue {
-	ASTNodeIndex name;
-	Value        val;
+// memo table of plain evaluation -- results of calls of pure defuns, keyed by defun and arg values; a defun is pure when neither it
+// nor any defun it calls does i/o or reads vars of scopes enclosing it; the table is direct-mapped, an insert evicting the entry it
+// collides with
+struct MemoTable {
+	// facts of a defun, including those of the defuns it calls
+	struct Fact {
+		bool     io;   // does print or read
+		uint32_t free; // least lexical depth of vars read outside the defun, if any
+	};
+
+	struct Entry {
+		ASTNodeIndex defun; // nullidx if empty
+		Value        result;
+	};
+
+	std::pmr::vector< Fact >  facts;   // per AST node, meaningful for defuns
+	std::pmr::vector< Entry > entries; // power-of-two count
+	std::pmr::vector< Value > keys;    // per entry, arg values at a stride of the max arity of pure defuns
+	std::pmr::vector< Value > pending; // args of calls under evaluation, to insert their results by
+	size_t stride = 0;
+	size_t analyzed = 0;  // count of AST nodes analyzed so far
+	size_t hits = 0;
+	size_t misses = 0;
+	size_t evictions = 0;
+
+	static constexpr size_t maxCapacity = size_t(1) << 30; // entries, keeping the rounding to a power of two clear of overflow
+
+	void init(const size_t capacity);
+	void analyze(const ASTNodes& tree);
+
+	bool enabled() const { return !entries.empty(); }
+	bool isPure(const ASTNodeIndex defun) const { return !facts[defun].io && uint32_t(-1) == facts[defun].free; }
+
+	const Value* find(const ASTNodeIndex defun, const Value* args, const size_t count);
+	void insert(const ASTNodeIndex defun, const Value* args, const size_t count, const Value result);
+
+private:
+	size_t getEntry(const ASTNodeIndex defun, const Value* args, const size_t count) const;
+};
+
+// size the table to the given count of entries, rounded up to a power of two
+void MemoTable::init(const size_t capacity)
+{
+	size_t count = 1;
+	while (count < capacity)
+		count *= 2;
+
+	entries.assign(count, Entry{ .defun = nullidx });
+}
+
+// analyze the defuns parsed since the last analysis; those can call only defuns parsed before them or among them, so facts of earlier
+// defuns are final
+void MemoTable::analyze(const ASTNodes& tree)
+{
+	const size_t from = analyzed;
+	analyzed = tree.size();
+	facts.resize(tree.size(), Fact{ .io = false, .free = uint32_t(-1) });
+
+	// calls among the new defuns, as (callee, caller)
+	std::pmr::vector< std::pair< ASTNodeIndex, ASTNodeIndex > > calls;
+	std::pmr::vector< ASTNodeIndex > work;
+
+	for (ASTNodeIndex defun = from; defun < tree.size(); ++defun) {
+		if (!tree[defun].isDefun())
+			continue;
+
+		// facts of the body proper, not counting nested defuns
+		Fact& fact = facts[defun];
+		work.push_back(defun);
+
+		while (!work.empty()) {
+			const ASTNode& node = tree[work.back()];
+			work.pop_back();
+
+			if (ASTNODE_EVAL_VAR == node.type && node.depth < tree[defun].depth)
+				fact.free = std::min(fact.free, node.depth);
+			else
+			if (ASTNODE_EVAL_FUN == node.type) {
+				if (INTRIN_PRINT == node.eval || INTRIN_READ_I32 == node.eval || INTRIN_READ_F32 == node.eval)
+					fact.io = true;
+				else
+				if (node.eval < tree.size())
+					calls.push_back(std::make_pair(node.eval, defun));
+			}
+
+			for (ASTNodeIndex it = node.first; nullidx != it; it = tree[it].next)
+				if (!tree[it].isDefun())
+					work.push_back(it);
+		}
+	}
+
+	// callers take on the facts of their callees; revisit the callers of a defun whose facts change, till none do
+	std::sort(calls.begin(), calls.end());
+
+	for (const auto& call : calls)
+		work.push_back(call.first);
+
+	while (!work.empty()) {
+		const ASTNodeIndex callee = work.back();
+		work.pop_back();
+
+		const Fact& src = facts[callee];
+		auto it = std::lower_bound(calls.begin(), calls.end(), std::make_pair(callee, ASTNodeIndex(0)));
+
+		for (; calls.end() != it && callee == it->first; ++it) {
+			Fact& dst = facts[it->second];
+			// vars the callee reads at the depth of the caller or deeper are those of the caller or of defuns nested in it
+			const uint32_t free = src.free < tree[it->second].depth ? std::min(dst.free, src.free) : dst.free;
+
+			const bool io = dst.io || src.io;
+
+			if (dst.io != io || dst.free != free) {
+				dst.io = io;
+				dst.free = free;
+				work.push_back(it->second);
+			}
+		}
+	}
+
+	// keys are laid out at the max arity of pure defuns; a wider one restarts the table
+	size_t arity = stride;
+
+	for (ASTNodeIndex defun = from; defun < tree.size(); ++defun)
+		if (tree[defun].isDefun() && isPure(defun))
+			arity = std::max(arity, getSubCount(true, defun, tree));
+
+	if (enabled() && stride < arity) {
+		stride = arity;
+		keys.resize(entries.size() * stride);
+
+		for (Entry& entry : entries)
+			entry.defun = nullidx;
+	}
+}
+
+size_t MemoTable::getEntry(const ASTNodeIndex defun, const Value* args, const size_t count) const
+{
+	uint64_t hash = defun * 0x9e3779b97f4a7c15;
+
+	for (size_t i = 0; i < count; ++i)
+		hash = (hash ^ uint64_t(args[i].type) << 32 ^ uint32_t(args[i].i32)) * 0x9e3779b97f4a7c15;
+
+	return (hash ^ hash >> 32) & (entries.size() - 1);
+}
+
+// get the memoized result of a call, if any
+const Value* MemoTable::find(const ASTNodeIndex defun, const Value* args, const size_t count)
+{
+	const size_t i = getEntry(defun, args, count);
+
+	if (defun == entries[i].defun) {
+		const Value* const key = keys.data() + i * stride;
+		size_t j = 0;
+
+		// args match by bits, so that f32 -0 and nan are told apart
+		while (j < count && key[j].type == args[j].type && key[j].i32 == args[j].i32)
+			j++;
+
+		if (count == j) {
+			hits++;
+			return &entries[i].result;
+		}
+	}
+
+	misses++;
+	return nullptr;
+}
+
+void MemoTable::insert(const ASTNodeIndex defun, const Value* args, const size_t count, const Value result)
+{
+	const size_t i = getEntry(defun, args, count);
+
+	if (nullidx != entries[i].defun)
+		evictions++;
+
+	entries[i] = Entry{ .defun = defun, .result = result };
+
+	for (size_t j = 0; j < count; ++j)
+		keys[i * stride + j] = Value{ .type = args[j].type, .i32 = args[j].i32 };
+}
+
+struct Jit;
+
+// state of a self-specializing node of plain evaluation -- arithmetic and 'if' nodes specialize to i32 operands on their first
+// evaluation if those are such, and fall back to generic operands for good once their guard sees otherwise
+enum NodeState : uint8_t {
+	NODE_UNINIT,
+	NODE_I32,
+	NODE_GENERIC
 };
 
-typedef std::vector< NamedValue > VarStack;
+// var stack -- values of the vars of all active scopes, in a frame of fixed layout per scope instance; the frame of the innermost
+// active instance at each lexical depth is tracked by a display
+struct VarStack {
+	// active scope, for restoring the display past the scope; tracked by plain evaluation only
+	struct Scope {
+		uint32_t depth;   // lexical depth
+		size_t   frame;   // start of the frame
+		size_t   restore; // display entry at the depth before the scope
+	};
+
+	std::pmr::vector< Value >  vars;    // var values, per frame in order of 'init' statements
+	std::pmr::vector< bool >   literals; // per var: of a literal value; tracked by partial evaluation only
+	std::pmr::vector< size_t > display; // per lexical depth, start of the innermost active frame
+	std::pmr::vector< Scope >  scopes;  // active scopes, innermost last
+	std::pmr::vector< NodeState > states; // per AST node: state of self-specializing nodes; used by plain evaluation only
+	MemoTable* memo = nullptr;          // memo table of calls of pure defuns, if memoizing; used by plain evaluation only
+	Jit*       jit = nullptr;           // compiler of defuns to native code, if compiling; used by plain evaluation only
+};
 
-Value eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack);
+PEValue eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack);
 
 template < int32_t BINOP_I32(int32_t, int32_t), float BINOP_F32(float, float) >
-Value evalArith(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
+PEValue evalArith(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 {
 	assert(nullidx != index && index < tree.size());
 
@@ -1250,8 +2589,9 @@ Value evalArith(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 	bool isF32 = false;
 
 	// arithmetic intrinsics have at least two args
-	ASTNodeIndices::const_iterator it = tree[index].args.begin();
-	const Value arg = eval(*it++, tree, stack);
+	ASTNodeIndex it = tree[index].first;
+	const PEValue arg = eval(it, tree, stack);
+	it = tree[it].next;
 
 	// establish 'literal', 'sidefx' and 'incoh' statuses -- first as an intersection, next two as a union of the respective arg statuses
 	bool literal = arg.literal;
@@ -1259,54 +2599,56 @@ Value evalArith(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 	bool incoh = arg.incoh;
 
 	// promote computation to f32 at the first encounter of an f32 arg
-	if (ASTRETURN_F32 == arg.type) {
-		acc_f32 = arg.f32;
+	if (ASTRETURN_F32 == arg.value.type) {
+		acc_f32 = arg.value.f32;
 		isF32 = true;
 	}
 	else {
-		assert(ASTRETURN_I32 == arg.type);
-		acc_i32 = arg.i32;
+		assert(ASTRETURN_I32 == arg.value.type);
+		acc_i32 = arg.value.i32;
 	}
 
 	if (!isF32) {
-		for (; it != tree[index].args.end(); ++it) {
-			const Value arg = eval(*it, tree, stack);
+		for (; nullidx != it; it = tree[it].next) {
+			const PEValue arg = eval(it, tree, stack);
 			literal &= arg.literal;
 			sidefx |= arg.sidefx;
 			incoh |= arg.incoh;
 
-			if (ASTRETURN_F32 == arg.type) {
-				++it; // we are done with this arg
-				acc_f32 = BINOP_F32(float(acc_i32), arg.f32);
+			if (ASTRETURN_F32 == arg.value.type) {
+				it = tree[it].next; // we are done with this arg
+				acc_f32 = BINOP_F32(float(acc_i32), arg.value.f32);
 				isF32 = true;
 				break;
 			}
 
-			assert(ASTRETURN_I32 == arg.type);
-			acc_i32 = BINOP_I32(acc_i32, arg.i32);
+			assert(ASTRETURN_I32 == arg.value.type);
+			acc_i32 = BINOP_I32(acc_i32, arg.value.i32);
 		}
 	}
 
 	if (isF32) {
-		for (; it != tree[index].args.end(); ++it) {
-			const Value arg = eval(*it, tree, stack);
+		for (; nullidx != it; it = tree[it].next) {
+			const PEValue arg = eval(it, tree, stack);
 			literal &= arg.literal;
 			sidefx |= arg.sidefx;
 			incoh |= arg.incoh;
 
-			if (ASTRETURN_I32 == arg.type) {
-				acc_f32 = BINOP_F32(acc_f32, float(arg.i32));
+			if (ASTRETURN_I32 == arg.value.type) {
+				acc_f32 = BINOP_F32(acc_f32, float(arg.value.i32));
 			}
 			else {
-				assert(ASTRETURN_F32 == arg.type);
-				acc_f32 = BINOP_F32(acc_f32, arg.f32);
+				assert(ASTRETURN_F32 == arg.value.type);
+				acc_f32 = BINOP_F32(acc_f32, arg.value.f32);
 			}
 		}
 	}
 
-	return isF32
-		? Value{ .type = ASTRETURN_F32, .literal = literal, .sidefx = sidefx, .incoh = incoh, { .f32 = acc_f32 } } // enclose anonymous union to workaround clang bug
-		: Value{ .type = ASTRETURN_I32, .literal = literal, .sidefx = sidefx, .incoh = incoh, { .i32 = acc_i32 } };
+	return PEValue{
+		.value = isF32 ? Value{ .type = ASTRETURN_F32, .f32 = acc_f32 } : Value{ .type = ASTRETURN_I32, .i32 = acc_i32 },
+		.literal = literal,
+		.sidefx = sidefx,
+		.incoh = incoh };
 }
 
 template < typename T >
@@ -1340,51 +2682,81 @@ void copySubtree(const ASTNodeIndex srcIdx, const ASTNodeIndex dstIdx, ASTNodes&
 {
 	assert(nullidx != srcIdx && srcIdx < tree.size());
 	assert(nullidx != dstIdx && dstIdx < tree.size());
-	assert(tree[dstIdx].args.empty());
+	assert(nullidx == tree[dstIdx].first);
 
-	for (ASTNodeIndices::const_iterator it = tree[srcIdx].args.begin(); it != tree[srcIdx].args.end(); ++it) {
-		ASTNode newnode = tree[*it];
-		newnode.parent = dstIdx;
-		newnode.args.clear();
+	for (ASTNodeIndex it = tree[srcIdx].first; nullidx != it; it = tree[it].next) {
+		ASTNode newnode = tree[it];
+		newnode.first = nullidx;
+		newnode.next = nullidx;
 
-		const ASTNodeIndex newnodeIdx = tree.size();
-		tree.push_back(newnode);
+		ASTNodeInfo newinfo = tree.info(it);
+		newinfo.parent = dstIdx;
+		newinfo.last = nullidx;
 
-		tree[dstIdx].args.push_back(newnodeIdx);
-		copySubtree(*it, newnodeIdx, tree);
+		const ASTNodeIndex newnodeIdx = tree.push(newnode, newinfo);
+
+		appendChild(dstIdx, newnodeIdx, tree);
+		copySubtree(it, newnodeIdx, tree);
 	}
 }
 
 void replaceChild(const ASTNodeIndex oldIdx, const ASTNodeIndex newIdx, const ASTNodeIndex parent, ASTNodes& tree)
 {
 	assert(nullidx != parent && parent < tree.size());
-	const ASTNodeIndices::iterator end = tree[parent].args.end();
-	ASTNodeIndices::iterator it = tree[parent].args.begin();
-	for (; it != end && oldIdx != *it; ++it) {}
-	assert(end != it);
-	*it = newIdx;
+
+	// the args of an inlined invocation are shared with the init-statements of the inlined defun, so those are replaced only as
+	// shown among the args of the invocation, keeping sibling lists intact
+	if (ASTNODE_EVAL_FUN == tree[parent].type && tree[parent].eval < INTRIN_READ_F32) {
+		assert(ASTNODE_EVAL_FUN == tree[oldIdx].type);
+		tree.info(oldIdx).init = newIdx;
+		return;
+	}
+
+	ASTNodeIndex prev = nullidx;
+	ASTNodeIndex it = tree[parent].first;
+	for (; nullidx != it && oldIdx != it; prev = it, it = tree[it].next) {}
+	assert(nullidx != it);
+
+	// new node takes the place of the old one in the sibling list
+	tree[newIdx].next = tree[oldIdx].next;
+
+	if (nullidx == prev)
+		tree[parent].first = newIdx;
+	else
+		tree[prev].next = newIdx;
+
+	if (oldIdx == tree.info(parent).last)
+		tree.info(parent).last = newIdx;
 }
 
 template < bool PREDOP_I32(int32_t, int32_t), bool PREDOP_F32(float, float) >
-Value evalIf(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack, bool& obsolete)
+PEValue evalIf(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack, bool& obsolete)
 {
-	assert(3 == tree[index].args.size());
-	Value ret = eval(tree[index].args[0], tree, stack);
+	assert(3 == getChildCount(index, tree));
+	PEValue ret = eval(tree[index].first, tree, stack);
 	const bool literal = ret.literal;
 	const bool sidefx = ret.sidefx;
-	const size_t branch = (ASTRETURN_F32 == ret.type ? PREDOP_F32(0.f, ret.f32) : PREDOP_I32(0, ret.i32)) ? 1 : 2;
+	const size_t branch = (ASTRETURN_F32 == ret.value.type ? PREDOP_F32(0.f, ret.value.f32) : PREDOP_I32(0, ret.value.i32)) ? 1 : 2;
 
 	// next eval may inline, replacing the original node branched to with a new node
-	ret = eval(tree[index].args[branch], tree, stack);
+	ret = eval(getChild(index, branch, tree), tree, stack);
 	ret.literal &= literal;
 	ret.sidefx |= sidefx;
-	ret.incoh |= !literal && tree[tree[index].args[1]].rtype != tree[tree[index].args[2]].rtype;
+	ret.incoh |= !literal && tree[getChild(index, 1, tree)].rtype != tree[getChild(index, 2, tree)].rtype;
 
 	if (literal) {
-		if (sidefx)
-			tree[index] = ASTNode{ .rtype = ASTRETURN_NONE, .type = ASTNODE_LET, .parent = tree[index].parent, .args = { tree[index].args[0], tree[index].args[branch] } };
+		const ASTNodeIndex taken = getChild(index, branch, tree);
+
+		if (sidefx) {
+			// the predicate may have been replaced by its eval, so fetch it anew
+			const ASTNodeIndex pred = tree[index].first;
+			tree[index] = ASTNode{ .first = pred, .next = tree[index].next, .type = ASTNODE_LET, .rtype = ASTRETURN_NONE };
+			tree.info(index).last = taken;
+			tree[pred].next = taken;
+			tree[taken].next = nullidx;
+		}
 		else {
-			replaceChild(index, tree[index].args[branch], tree[index].parent, tree);
+			replaceChild(index, taken, tree.info(index).parent, tree);
 			obsolete = true;
 		}
 	}
@@ -1397,60 +2769,78 @@ bool predop_eq(T a, T b) { return a == b; }
 template < typename T >
 bool predop_gt(T a, T b) { return a > b; }
 
-Value eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
+// arithmetic and predicates on plain values, for the evaluators that do not partially evaluate
+template < int32_t BINOP_I32(int32_t, int32_t), float BINOP_F32(float, float) >
+Value applyArith(const Value a, const Value b)
+{
+	if (ASTRETURN_I32 == a.type && ASTRETURN_I32 == b.type)
+		return Value{ .type = ASTRETURN_I32, .i32 = BINOP_I32(a.i32, b.i32) };
+
+	const float fa = ASTRETURN_F32 == a.type ? a.f32 : float(a.i32);
+	const float fb = ASTRETURN_F32 == b.type ? b.f32 : float(b.i32);
+	return Value{ .type = ASTRETURN_F32, .f32 = BINOP_F32(fa, fb) };
+}
+
+template < bool PREDOP_I32(int32_t, int32_t), bool PREDOP_F32(float, float) >
+bool applyPred(const Value a)
+{
+	return ASTRETURN_F32 == a.type ? PREDOP_F32(0.f, a.f32) : PREDOP_I32(0, a.i32);
+}
+
+PEValue eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 {
 	assert(nullidx != index && index < tree.size());
-	const size_t stackRestore = stack.size();
-	Value ret{ .type = ASTRETURN_NONE };
+	const size_t stackRestore = stack.vars.size();
+	PEValue ret{ .value = Value{ .type = ASTRETURN_NONE } };
 	bool obsolete = false;
 
 	switch (tree[index].type) {
 	case ASTNODE_LET:
 		{
 			bool sidefx = false;
-			ASTNodeIndices::const_iterator it = tree[index].args.begin();
+			ASTNodeIndex it = tree[index].first;
 			// initializations, when present, are mandatorily first
-			for (; it != tree[index].args.end() && tree[*it].isInitialize(); ++it) {
-				ret = eval(*it, tree, stack);
+			for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next) {
+				ret = eval(it, tree, stack);
 				sidefx |= ret.sidefx;
 			}
-			// de-anonymize any newly-initialized vars
-			ASTNodeIndices::const_iterator jt = tree[index].args.begin();
-			for (VarStack::iterator st = stack.begin() + stackRestore; st != stack.end(); ++st, ++jt) {
-				assert(ASTNODE_INIT == tree[*jt].type && nullidx != tree[*jt].eval);
-				st->name = tree[*jt].eval;
-			}
-			assert(jt == it);
+			assert(stack.vars.size() - stackRestore == getSubCount(true, index, tree));
+			// make the frame of newly-initialized vars the innermost one at this depth
+			const uint32_t depth = tree[index].depth;
+			if (stack.display.size() <= depth)
+				stack.display.resize(depth + 1);
+			const size_t displayRestore = stack.display[depth];
+			stack.display[depth] = stackRestore;
 			// eval the rest of the expressions in this scope
-			for (; it != tree[index].args.end(); ++it) {
-				if (tree[*it].isDefun())
+			for (; nullidx != it; it = tree[it].next) {
+				if (tree[it].isDefun())
 					continue;
 
-				ret = eval(*it, tree, stack);
+				ret = eval(it, tree, stack);
 				sidefx |= ret.sidefx;
 			}
 			ret.sidefx = sidefx;
 			// pop locals from the var stack
-			stack.resize(stackRestore);
+			stack.vars.resize(stackRestore);
+			stack.literals.resize(stackRestore);
+			stack.display[depth] = displayRestore;
 			break;
 		}
 	case ASTNODE_INIT:
-		// init the local var and put it on the stack anonymized
-		assert(!tree[index].args.empty());
-		ret = eval(tree[index].args.front(), tree, stack);
-		stack.push_back(NamedValue{ .name = nullidx, .val = ret });
-		// stack is a sidefx terminator -- values that end up on the stack lose sidefx
-		stack.back().val.sidefx = false;
-		// same goes for type incoherence
-		stack.back().val.incoh = false;
+		// init the local var and put it on the stack; it is not visible until its frame is complete
+		assert(nullidx != tree[index].first);
+		ret = eval(tree[index].first, tree, stack);
+		// stack is a sidefx terminator -- values that end up on the stack lose sidefx; same goes for type incoherence
+		stack.vars.push_back(ret.value);
+		stack.literals.push_back(ret.literal);
 		break;
 	case ASTNODE_EVAL_VAR:
 		{
-			// scan the var stack from the top down for our var
-			VarStack::const_reverse_iterator it = stack.rbegin();
-			for (; it != stack.rend() && it->name != tree[index].eval; ++it) {}
-			assert(it != stack.rend());
-			ret = it->val;
+			// fetch our var from the innermost frame of its scope depth
+			assert(tree[index].depth < stack.display.size());
+			const size_t pos = stack.display[tree[index].depth] + tree[index].slot;
+			assert(pos < stack.vars.size());
+			ret = PEValue{ .value = stack.vars[pos], .literal = stack.literals[pos] };
 			break;
 		}
 	case ASTNODE_EVAL_FUN:
@@ -1474,39 +2864,41 @@ Value eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 			ret = evalIf< predop_gt< int32_t >, predop_gt< float > >(index, tree, stack, obsolete);
 			break;
 		case INTRIN_PRINT:
-			assert(1 == tree[index].args.size());
-			ret = eval(tree[index].args[0], tree, stack);
+			assert(1 == getChildCount(index, tree));
+			ret = eval(tree[index].first, tree, stack);
 
-			if (ASTRETURN_F32 == ret.type)
-				fprintf(stdout, "%f\n", ret.f32);
+			if (ASTRETURN_F32 == ret.value.type)
+				fprintf(stdout, "%f\n", ret.value.f32);
 			else
-				fprintf(stdout, "%d\n", ret.i32);
+				fprintf(stdout, "%d\n", ret.value.i32);
 
 			ret.sidefx = true;
 			break;
 		case INTRIN_READ_I32:
 			// nothing to update in a read node -- just return
-			return Value{ .type = ASTRETURN_I32, .i32 = read<int32_t>("i: ", "%d") };
+			return PEValue{ .value = Value{ .type = ASTRETURN_I32, .i32 = read<int32_t>("i: ", "%d") } };
 		case INTRIN_READ_F32:
 			// nothing to update in a read node -- just return
-			return Value{ .type = ASTRETURN_F32, .f32 = read<float>("f: ", "%f") };
+			return PEValue{ .value = Value{ .type = ASTRETURN_F32, .f32 = read<float>("f: ", "%f") } };
 		default:
 			{
-				// inline the target defun as a let-expression
-				ASTNode newnode = { .rtype = ASTRETURN_NONE, .type = ASTNODE_LET, .parent = tree[index].parent };
+				// inline the target defun as a let-expression of the lexical depth of the defun
+				const ASTNode newnode = { .depth = tree[tree[index].eval].depth, .type = ASTNODE_LET, .rtype = ASTRETURN_NONE };
+				const ASTNodeInfo newinfo = { .parent = tree.info(index).parent };
 
-				const ASTNodeIndex newnodeIdx = tree.size();
-				tree.push_back(newnode);
+				const ASTNodeIndex newnodeIdx = tree.push(newnode, newinfo);
 				copySubtree(tree[index].eval, newnodeIdx, tree);
 
 				// patch parent with the newly created let-expression child
-				replaceChild(index, newnodeIdx, tree[index].parent, tree);
-
-				// patch init-statements with the respective args from the invocation
-				ASTNodeIndices::const_iterator at = tree[newnodeIdx].args.begin();
-				for (ASTNodeIndices::const_iterator it = tree[index].args.begin(); it != tree[index].args.end(); ++it, ++at) {
-					assert(ASTNODE_INIT == tree[*at].type && tree[*at].args.empty());
-					tree[*at].args.push_back(*it);
+				replaceChild(index, newnodeIdx, tree.info(index).parent, tree);
+
+				// patch init-statements with the respective args from the invocation, sharing the args with it; those keep the
+				// invocation for parent, so the init-statements show the args as passed
+				ASTNodeIndex at = tree[newnodeIdx].first;
+				for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next, at = tree[at].next) {
+					assert(ASTNODE_INIT == tree[at].type && nullidx == tree[at].first);
+					tree[at].first = it;
+					tree.info(at).last = it;
 				}
 				// execute the callee this time as a let-expression
 				return eval(newnodeIdx, tree, stack);
@@ -1517,89 +2909,3759 @@ Value eval(const ASTNodeIndex index, ASTNodes& tree, VarStack& stack)
 		switch (tree[index].rtype) {
 		case ASTRETURN_I32:
 			// nothing to update in a literal node -- just return
-			return Value{ .type = ASTRETURN_I32, .literal = true, .i32 = tree[index].literal_i32 };
+			return PEValue{ .value = Value{ .type = ASTRETURN_I32, .i32 = tree[index].literal_i32 }, .literal = true };
 		case ASTRETURN_F32:
 			// nothing to update in a literal node -- just return
-			return Value{ .type = ASTRETURN_F32, .literal = true, .f32 = tree[index].literal_f32 };
+			return PEValue{ .value = Value{ .type = ASTRETURN_F32, .f32 = tree[index].literal_f32 }, .literal = true };
 		}
 		break;
 	}
 
-	assert(ASTRETURN_NONE != ret.type);
+	assert(ASTRETURN_NONE != ret.value.type);
 	if (!obsolete) {
 		// check if node can be collapsed into a literal; not for root or init-statements
 		if (index && !tree[index].isInitialize() && ret.literal && !ret.sidefx) {
-			switch (ret.type) {
+			switch (ret.value.type) {
 			case ASTRETURN_I32:
-				tree[index] = ASTNode{ .literal_i32 = ret.i32, .rtype = ret.type, .type = ASTNODE_LITERAL, .parent = tree[index].parent };
+				tree[index] = ASTNode{ .literal_i32 = ret.value.i32, .next = tree[index].next, .type = ASTNODE_LITERAL, .rtype = ret.value.type };
 				break;
 			case ASTRETURN_F32:
-				tree[index] = ASTNode{ .literal_f32 = ret.f32, .rtype = ret.type, .type = ASTNODE_LITERAL, .parent = tree[index].parent };
+				tree[index] = ASTNode{ .literal_f32 = ret.value.f32, .next = tree[index].next, .type = ASTNODE_LITERAL, .rtype = ret.value.type };
 				break;
 			}
 		}
 		else
-			tree[index].rtype = ret.incoh ? ASTRETURN_UNKNOWN : ret.type;
+			tree[index].rtype = ret.incoh ? ASTRETURN_UNKNOWN : ret.value.type;
 	}
 
 	return ret;
 }
 
+Value evalPure(ASTNodeIndex index, const ASTNodes& tree, VarStack& stack);
+bool callNative(Jit& jit, const ASTNodeIndex defun, const Value* args, const size_t count, const ASTNodes& tree, Value& ret);
+
+// make a frame of vars at the top of the var stack the innermost one at the depth of its scope
+void enterPureScope(const uint32_t depth, const size_t frame, VarStack& stack)
+{
+	if (stack.display.size() <= depth)
+		stack.display.resize(depth + 1);
+
+	stack.scopes.push_back(VarStack::Scope{ .depth = depth, .frame = frame, .restore = stack.display[depth] });
+	stack.display[depth] = frame;
+}
+
+// leave the innermost scopes past the given count of scopes, as long as those are of the given lexical depth or deeper; return
+// the frame of the outermost scope left, or the given frame if none left
+size_t leavePureScopes(const size_t mark, const uint32_t depth, size_t frame, VarStack& stack)
+{
+	while (mark < stack.scopes.size() && depth <= stack.scopes.back().depth) {
+		const VarStack::Scope& scope = stack.scopes.back();
+		stack.display[scope.depth] = scope.restore;
+		frame = scope.frame;
+		stack.scopes.pop_back();
+	}
+
+	return frame;
+}
+
+// evaluate the sub-expressions of a scope past its var inits, but the last one; return the last one
+ASTNodeIndex evalPureBody(ASTNodeIndex it, const ASTNodes& tree, VarStack& stack)
+{
+	ASTNodeIndex last = nullidx;
+
+	for (; nullidx != it; it = tree[it].next) {
+		if (tree[it].isDefun())
+			continue;
+
+		if (nullidx != last)
+			evalPure(last, tree, stack);
+
+		last = it;
+	}
+
+	assert(nullidx != last);
+	return last;
+}
+
+template < int32_t BINOP_I32(int32_t, int32_t), float BINOP_F32(float, float) >
+Value evalPureArith(const ASTNodeIndex index, const ASTNodes& tree, VarStack& stack);
+
+// evaluate an operand of an intrinsic; literals and vars are read in place, and nested arithmetic is evaluated directly, as none
+// of those enter scopes or call defuns
+inline Value evalPureOperand(const ASTNodeIndex index, const ASTNodes& tree, VarStack& stack)
+{
+	const ASTNode& node = tree[index];
+
+	switch (node.type) {
+	case ASTNODE_EVAL_VAR:
+		return stack.vars[stack.display[node.depth] + node.slot];
+	case ASTNODE_LITERAL:
+		return ASTRETURN_F32 == node.rtype
+			? Value{ .type = ASTRETURN_F32, .f32 = node.literal_f32 }
+			: Value{ .type = ASTRETURN_I32, .i32 = node.literal_i32 };
+	case ASTNODE_EVAL_FUN:
+		switch (node.eval) {
+		case INTRIN_PLUS:
+			return evalPureArith< binop_plus< int32_t >, binop_plus< float > >(index, tree, stack);
+		case INTRIN_MINUS:
+			return evalPureArith< binop_minus< int32_t >, binop_minus< float > >(index, tree, stack);
+		case INTRIN_MUL:
+			return evalPureArith< binop_mul< int32_t >, binop_mul< float > >(index, tree, stack);
+		case INTRIN_DIV:
+			return evalPureArith< binop_div< int32_t >, binop_div< float > >(index, tree, stack);
+		default:
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return evalPure(index, tree, stack);
+}
+
+template < int32_t BINOP_I32(int32_t, int32_t), float BINOP_F32(float, float) >
+Value evalPureArith(const ASTNodeIndex index, const ASTNodes& tree, VarStack& stack)
+{
+	// arithmetic intrinsics have at least two args
+	NodeState& state = stack.states[index];
+	ASTNodeIndex it = tree[index].first;
+	Value ret = evalPureOperand(it, tree, stack);
+	it = tree[it].next;
+
+	// a node not generic yet folds i32 operands with no checks of types past the guard of each; an operand of another type
+	// makes the node generic, and the fold goes on from that operand
+	if (NODE_GENERIC != state && ASTRETURN_I32 == ret.type) {
+		int32_t acc = ret.i32;
+
+		for (; nullidx != it; it = tree[it].next) {
+			const Value arg = evalPureOperand(it, tree, stack);
+
+			if (ASTRETURN_I32 != arg.type) {
+				ret = applyArith< BINOP_I32, BINOP_F32 >(Value{ .type = ASTRETURN_I32, .i32 = acc }, arg);
+				it = tree[it].next;
+				break;
+			}
+
+			acc = BINOP_I32(acc, arg.i32);
+		}
+
+		if (nullidx == it && ASTRETURN_I32 == ret.type) {
+			state = NODE_I32;
+			return Value{ .type = ASTRETURN_I32, .i32 = acc };
+		}
+	}
+
+	state = NODE_GENERIC;
+
+	for (; nullidx != it; it = tree[it].next)
+		ret = applyArith< BINOP_I32, BINOP_F32 >(ret, evalPureOperand(it, tree, stack));
+
+	return ret;
+}
+
+// get the branch taken by an 'if'; a node not generic yet tests an i32 predicate past the guard of its type
+template < bool PREDOP_I32(int32_t, int32_t), bool PREDOP_F32(float, float) >
+ASTNodeIndex evalPureIf(const ASTNodeIndex index, const ASTNodes& tree, VarStack& stack)
+{
+	NodeState& state = stack.states[index];
+	const ASTNodeIndex pred = tree[index].first;
+	const Value value = evalPureOperand(pred, tree, stack);
+	bool taken;
+
+	if (NODE_GENERIC != state && ASTRETURN_I32 == value.type) {
+		state = NODE_I32;
+		taken = PREDOP_I32(0, value.i32);
+	}
+	else {
+		state = NODE_GENERIC;
+		taken = applyPred< PREDOP_I32, PREDOP_F32 >(value);
+	}
+
+	return taken ? tree[pred].next : tree[tree[pred].next].next;
+}
+
+// evaluate AST without partial evaluation -- the AST is left intact and no PE statuses are tracked; defuns are called by evaluating
+// their sub-expressions in a new frame of the args, so memory use is bound by the depth of recursion; expressions in tail position
+// are evaluated in place of the current one, and calls in tail position drop the scopes the callee cannot see, so recursion in tail
+// position runs in constant space; calls not in tail position are looked up in the memo table, if any; calls of defuns compiled to
+// native code are carried out by that
+Value evalPure(ASTNodeIndex index, const ASTNodes& tree, VarStack& stack)
+{
+	const size_t mark = stack.scopes.size();
+	Value ret{ .type = ASTRETURN_NONE };
+	ASTNodeIndex memoized = nullidx;
+	size_t memoCount = 0;
+
+	for (bool tail = true; tail; ) {
+		assert(nullidx != index && index < tree.size());
+		const ASTNode& node = tree[index];
+		tail = false;
+
+		switch (node.type) {
+		case ASTNODE_LET:
+			{
+				const size_t frame = stack.vars.size();
+				ASTNodeIndex it = node.first;
+				// initializations, when present, are mandatorily first; a var is not visible until its frame is complete
+				for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next) {
+					const Value var = evalPure(tree[it].first, tree, stack);
+					stack.vars.push_back(var);
+				}
+
+				enterPureScope(node.depth, frame, stack);
+				index = evalPureBody(it, tree, stack);
+				tail = true;
+				break;
+			}
+		case ASTNODE_EVAL_VAR:
+			assert(node.depth < stack.display.size());
+			assert(stack.display[node.depth] + node.slot < stack.vars.size());
+			ret = stack.vars[stack.display[node.depth] + node.slot];
+			break;
+		case ASTNODE_EVAL_FUN:
+			switch (node.eval) {
+			case INTRIN_PLUS:
+				ret = evalPureArith< binop_plus< int32_t >, binop_plus< float > >(index, tree, stack);
+				break;
+			case INTRIN_MINUS:
+				ret = evalPureArith< binop_minus< int32_t >, binop_minus< float > >(index, tree, stack);
+				break;
+			case INTRIN_MUL:
+				ret = evalPureArith< binop_mul< int32_t >, binop_mul< float > >(index, tree, stack);
+				break;
+			case INTRIN_DIV:
+				ret = evalPureArith< binop_div< int32_t >, binop_div< float > >(index, tree, stack);
+				break;
+			case INTRIN_IFZERO:
+				index = evalPureIf< predop_eq< int32_t >, predop_eq< float > >(index, tree, stack);
+				tail = true;
+				break;
+			case INTRIN_IFNEG:
+				index = evalPureIf< predop_gt< int32_t >, predop_gt< float > >(index, tree, stack);
+				tail = true;
+				break;
+			case INTRIN_PRINT:
+				ret = evalPure(node.first, tree, stack);
+
+				if (ASTRETURN_F32 == ret.type)
+					fprintf(stdout, "%f\n", ret.f32);
+				else
+					fprintf(stdout, "%d\n", ret.i32);
+				break;
+			case INTRIN_READ_I32:
+				ret = Value{ .type = ASTRETURN_I32, .i32 = read<int32_t>("i: ", "%d") };
+				break;
+			case INTRIN_READ_F32:
+				ret = Value{ .type = ASTRETURN_F32, .f32 = read<float>("f: ", "%f") };
+				break;
+			default:
+				{
+					// args make the frame of the callee, in the order of its var inits
+					const ASTNodeIndex defun = node.eval;
+					const size_t args = stack.vars.size();
+					ASTNodeIndex at = tree[defun].first;
+
+					for (ASTNodeIndex it = node.first; nullidx != it; it = tree[it].next, at = tree[at].next) {
+						assert(nullidx != at && tree[at].isInitialize());
+						const Value var = evalPure(it, tree, stack);
+						stack.vars.push_back(var);
+					}
+
+					for (; nullidx != at && tree[at].isInitialize(); at = tree[at].next) {}
+
+					// a call ahead of any scope of this evaluation is the one whose result this evaluation returns, so its args
+					// are kept aside as the memo key for that result
+					MemoTable* const memo = stack.memo;
+
+					if (nullptr != memo && mark == stack.scopes.size() && memo->isPure(defun)) {
+						const size_t count = stack.vars.size() - args;
+						const Value* const hit = memo->find(defun, stack.vars.data() + args, count);
+
+						if (nullptr != hit) {
+							ret = *hit;
+							stack.vars.resize(args);
+							break;
+						}
+
+						memo->pending.insert(memo->pending.end(), stack.vars.begin() + args, stack.vars.end());
+						memoized = defun;
+						memoCount = count;
+					}
+
+					// type-stable defuns run as native code, once compiled for the types of their args
+					if (nullptr != stack.jit && callNative(*stack.jit, defun, stack.vars.data() + args, stack.vars.size() - args, tree, ret)) {
+						stack.vars.resize(args);
+						break;
+					}
+
+					// scopes of this evaluation at the depth of the callee or deeper are not visible to the callee -- its frame
+					// takes their place
+					const size_t frame = leavePureScopes(mark, tree[defun].depth, args, stack);
+
+					if (frame != args) {
+						const size_t count = stack.vars.size() - args;
+						for (size_t i = 0; i < count; ++i)
+							stack.vars[frame + i] = stack.vars[args + i];
+						stack.vars.resize(frame + count);
+					}
+
+					enterPureScope(tree[defun].depth, frame, stack);
+					index = evalPureBody(at, tree, stack);
+					tail = true;
+					break;
+				}
+			}
+			break;
+		case ASTNODE_LITERAL:
+			ret = ASTRETURN_F32 == node.rtype
+				? Value{ .type = ASTRETURN_F32, .f32 = node.literal_f32 }
+				: Value{ .type = ASTRETURN_I32, .i32 = node.literal_i32 };
+			break;
+		default:
+			assert(false);
+			break;
+		}
+	}
+
+	// leave all scopes entered by this evaluation
+	stack.vars.resize(leavePureScopes(mark, 0, stack.vars.size(), stack));
+
+	if (nullidx != memoized) {
+		MemoTable& memo = *stack.memo;
+		const size_t key = memo.pending.size() - memoCount;
+		memo.insert(memoized, memo.pending.data() + key, memoCount, ret);
+		memo.pending.resize(key);
+	}
+
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// static typing of (guaranteed correct) AST by specialization of defuns for the types of their args
+
+// get the type of the value of either of two expressions
+ASTReturnType joinTypes(const ASTReturnType a, const ASTReturnType b)
+{
+	if (ASTRETURN_NONE == a || a == b)
+		return b;
+
+	return ASTRETURN_NONE == b ? a : ASTRETURN_UNKNOWN;
+}
+
+// get the type of the result of arithmetic of two values; mixed operands are promoted to f32
+ASTReturnType getArithType(const ASTReturnType a, const ASTReturnType b)
+{
+	if (ASTRETURN_NONE == a || ASTRETURN_NONE == b)
+		return ASTRETURN_NONE;
+
+	if (ASTRETURN_UNKNOWN == a || ASTRETURN_UNKNOWN == b)
+		return ASTRETURN_UNKNOWN;
+
+	return ASTRETURN_I32 == a && ASTRETURN_I32 == b ? ASTRETURN_I32 : ASTRETURN_F32;
+}
+
+// static types of a program -- every defun gets a specialization per combination of arg types it is called with, and the expressions
+// of each specialization are typed given its args: i32 or f32 where known ahead of evaluation, unknown where up to the branch taken
+// by an 'if' or read from the frame of an enclosing function, unless the AST carries whole-program types or the whole program is
+// typed at once; top-level expressions are typed as they come, along with all specializations they call for; shared by the VM, the
+// JIT, the lowering to C and the whole-program inference
+struct Specializer {
+	// specialization of a defun by the static types of its args
+	struct Spec {
+		ASTNodeIndex  defun;
+		uint32_t      next;  // next specialization of the same defun, if any
+		uint32_t      sig;   // start of arg types in the pool
+		ASTReturnType rtype; // return type; none until inferred
+	};
+
+	std::pmr::vector<Spec>          specs;
+	std::pmr::vector<ASTReturnType> sigs;  // pool of arg types of specializations
+	std::pmr::vector<uint32_t>      heads; // per AST node: first specialization of defuns
+	std::pmr::vector<ASTReturnType> types;  // per AST node: static type of expressions and var inits of the last function typed
+	std::pmr::vector<ASTReturnType> joined; // per AST node: type of expressions, var inits and defuns joined over all typed, if whole
+	std::pmr::vector<ASTReturnType> args;   // types of args of the calls being typed
+	bool annotated = false;                 // return types of AST nodes are those of whole-program inference
+	bool whole = false;                     // the root of all is typed at once, so vars of enclosing functions are of joined types
+
+	void init(const ASTNodes& tree);
+	void infer(const ASTNodeIndex index, const ASTNodes& tree);
+	bool settle(const uint32_t from, const ASTNodeIndex index, const ASTNodes& tree);
+	ASTReturnType typeRoot(const ASTNodeIndex index, const ASTNodes& tree);
+	ASTReturnType typeFunction(const uint32_t spec, const ASTNodes& tree);
+	uint32_t getSpec(const ASTNodeIndex defun, const ASTReturnType* sig, const uint32_t count);
+
+private:
+	uint32_t depth;   // lexical depth of the function being typed
+	bool     changed; // joined types changed since the last pass
+
+	void setType(const ASTNodeIndex index, const ASTReturnType type);
+	ASTReturnType typeBody(ASTNodeIndex it, const ASTNodes& tree);
+	ASTReturnType typeExpr(const ASTNodeIndex index, const ASTNodes& tree);
+};
+
+// size the per-node state after the AST
+void Specializer::init(const ASTNodes& tree)
+{
+	heads.resize(tree.size(), nullidx);
+	types.resize(tree.size(), ASTRETURN_NONE);
+
+	if (whole)
+		joined.resize(tree.size(), ASTRETURN_NONE);
+}
+
+// type a top-level expression, or the root of all, and infer return types of all specializations it calls for till a fixpoint;
+// those still of no type never return, so any type will do for them, but that may call for more specializations
+void Specializer::infer(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	assert(nullidx != index && index < tree.size());
+	init(tree);
+
+	// specializations from earlier expressions are final, as none of those could call the defuns of this one
+	const uint32_t from = specs.size();
+
+	while (!settle(from, index, tree))
+		for (uint32_t i = from; i < specs.size(); ++i)
+			if (ASTRETURN_NONE == specs[i].rtype)
+				specs[i].rtype = ASTRETURN_I32;
+}
+
+// type a top-level expression, or the root of all, unless none, and infer return types of the specializations from the given one
+// on, along with all those they call for, till a fixpoint; return false if some are still of no type, i.e. never return
+bool Specializer::settle(const uint32_t from, const ASTNodeIndex index, const ASTNodes& tree)
+{
+	bool none = false;
+
+	do {
+		const uint32_t count = specs.size();
+		changed = false;
+
+		if (nullidx != index)
+			typeRoot(index, tree);
+
+		for (uint32_t i = from; i < specs.size(); ++i) {
+			const ASTReturnType rtype = joinTypes(specs[i].rtype, typeFunction(i, tree));
+			changed |= rtype != specs[i].rtype;
+			specs[i].rtype = rtype;
+
+			if (whole)
+				joined[specs[i].defun] = joinTypes(joined[specs[i].defun], rtype);
+		}
+
+		changed |= count != specs.size();
+	}
+	while (changed);
+
+	for (uint32_t i = from; i < specs.size(); ++i)
+		none |= ASTRETURN_NONE == specs[i].rtype;
+
+	return !none;
+}
+
+// type a top-level expression, or the root of all; return its type
+ASTReturnType Specializer::typeRoot(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	depth = 0;
+	return typeExpr(index, tree);
+}
+
+// type the body of a specialization; return its type
+ASTReturnType Specializer::typeFunction(const uint32_t spec, const ASTNodes& tree)
+{
+	const ASTNodeIndex defun = specs[spec].defun;
+	ASTNodeIndex it = tree[defun].first;
+	depth = tree[defun].depth;
+
+	for (uint32_t i = 0; nullidx != it && tree[it].isInitialize(); it = tree[it].next, ++i)
+		setType(it, sigs[specs[spec].sig + i]);
+
+	return typeBody(it, tree);
+}
+
+// get the specialization of a defun by the given arg types, making a new one if none
+uint32_t Specializer::getSpec(const ASTNodeIndex defun, const ASTReturnType* sig, const uint32_t count)
+{
+	uint32_t it = heads[defun];
+
+	for (; nullidx != it; it = specs[it].next)
+		if (std::equal(sig, sig + count, sigs.begin() + specs[it].sig))
+			return it;
+
+	it = specs.size();
+	specs.push_back(Spec{ .defun = defun, .next = heads[defun], .sig = uint32_t(sigs.size()), .rtype = ASTRETURN_NONE });
+	sigs.insert(sigs.end(), sig, sig + count);
+	heads[defun] = it;
+	return it;
+}
+
+// set the static type of a node, joining it into the whole-program one
+void Specializer::setType(const ASTNodeIndex index, const ASTReturnType type)
+{
+	types[index] = type;
+
+	if (whole) {
+		const ASTReturnType join = joinTypes(joined[index], type);
+		changed |= join != joined[index];
+		joined[index] = join;
+	}
+}
+
+// type a sequence of sub-expressions, skipping defuns; return the type of the last one
+ASTReturnType Specializer::typeBody(ASTNodeIndex it, const ASTNodes& tree)
+{
+	ASTReturnType ret = ASTRETURN_NONE;
+
+	for (; nullidx != it; it = tree[it].next)
+		if (!tree[it].isDefun())
+			ret = typeExpr(it, tree);
+
+	return ret;
+}
+
+ASTReturnType Specializer::typeExpr(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	const ASTNode& node = tree[index];
+	ASTReturnType ret = ASTRETURN_NONE;
+
+	switch (node.type) {
+	case ASTNODE_LET:
+		{
+			ASTNodeIndex it = node.first;
+			for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next)
+				setType(it, typeExpr(tree[it].first, tree));
+
+			ret = typeBody(it, tree);
+			break;
+		}
+	case ASTNODE_EVAL_VAR:
+		// vars of enclosing functions are read from whichever frame is innermost at their depth, so only their whole-program type
+		// holds for them; when typing the whole program, that is the join so far, widening till the fixpoint
+		if (node.depth < depth && whole)
+			ret = joined[tree.info(index).init];
+		else
+		if (node.depth < depth) {
+			const ASTReturnType type = tree[tree.info(index).init].rtype;
+			ret = annotated && (ASTRETURN_I32 == type || ASTRETURN_F32 == type) ? type : ASTRETURN_UNKNOWN;
+		}
+		else
+			ret = types[tree.info(index).init];
+		break;
+	case ASTNODE_EVAL_FUN:
+		switch (node.eval) {
+		case INTRIN_PLUS:
+		case INTRIN_MINUS:
+		case INTRIN_MUL:
+		case INTRIN_DIV:
+			ret = typeExpr(node.first, tree);
+
+			for (ASTNodeIndex it = tree[node.first].next; nullidx != it; it = tree[it].next)
+				ret = getArithType(ret, typeExpr(it, tree));
+			break;
+		case INTRIN_IFZERO:
+		case INTRIN_IFNEG:
+			typeExpr(node.first, tree);
+			ret = typeExpr(tree[node.first].next, tree);
+			ret = joinTypes(ret, typeExpr(tree[tree[node.first].next].next, tree));
+			break;
+		case INTRIN_PRINT:
+			ret = typeExpr(node.first, tree);
+			break;
+		case INTRIN_READ_I32:
+			ret = ASTRETURN_I32;
+			break;
+		case INTRIN_READ_F32:
+			ret = ASTRETURN_F32;
+			break;
+		default:
+			{
+				// the callee cannot be told till the types of all args are
+				const size_t mark = args.size();
+				bool known = true;
+
+				for (ASTNodeIndex it = node.first; nullidx != it; it = tree[it].next) {
+					args.push_back(typeExpr(it, tree));
+					known &= ASTRETURN_NONE != args.back();
+				}
+
+				if (known)
+					ret = specs[getSpec(node.eval, args.data() + mark, args.size() - mark)].rtype;
+
+				args.resize(mark);
+				break;
+			}
+		}
+		break;
+	case ASTNODE_LITERAL:
+		ret = ASTRETURN_F32 == node.rtype ? ASTRETURN_F32 : ASTRETURN_I32;
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	setType(index, ret);
+	return ret;
+}
+
+// whole-program types -- a single type per expression, var and defun, joined over all evaluations of those: the program is typed
+// from the root of all by specializations of its defuns, and each node takes the join of its types over all specializations, so
+// params take the join of the args of all calls of their defun, and a type is concrete wherever all call sites agree
+struct TypeInference {
+	std::pmr::vector<ASTReturnType> types; // per AST node: type of expressions, var inits and defuns; none if never of a value
+
+	void infer(const ASTNodes& tree);
+	size_t report(FILE* f, const ASTNodes& tree, const SymbolTable& symbols) const;
+	void annotate(ASTNodes& tree) const;
+};
+
+// code past calls of specializations that never return is never evaluated, so it is left of no type
+void TypeInference::infer(const ASTNodes& tree)
+{
+	Specializer typer;
+	typer.whole = true;
+	typer.init(tree);
+	typer.settle(0, 0, tree);
+	types.assign(typer.joined.begin(), typer.joined.end());
+}
+
+// report the params whose types the call sites of their defun disagree on, along with the type at each site; return the count of
+// such params
+size_t TypeInference::report(FILE* f, const ASTNodes& tree, const SymbolTable& symbols) const
+{
+	std::pmr::vector< std::pair< ASTReturnType, ASTNodeIndex > > sites;
+	size_t count = 0;
+
+	for (ASTNodeIndex defun = 0; defun < tree.size(); ++defun) {
+		if (!tree[defun].isDefun())
+			continue;
+
+		size_t pos = 0;
+		for (ASTNodeIndex param = tree[defun].first; nullidx != param && tree[param].isInitialize(); param = tree[param].next, ++pos) {
+			if (ASTRETURN_UNKNOWN != types[param])
+				continue;
+
+			// distinct pairs of arg type and calling defun, or the root
+			sites.clear();
+
+			for (ASTNodeIndex call = 0; call < tree.size(); ++call) {
+				if (ASTNODE_EVAL_FUN != tree[call].type || defun != tree[call].eval)
+					continue;
+
+				ASTNodeIndex arg = tree[call].first;
+				for (size_t i = 0; i < pos; ++i)
+					arg = tree[arg].next;
+
+				ASTNodeIndex caller = tree.info(call).parent;
+				while (caller && !tree[caller].isDefun())
+					caller = tree.info(caller).parent;
+
+				// args of no type are of calls that are never evaluated, so those do not take part in any conflict
+				const std::pair< ASTReturnType, ASTNodeIndex > site(types[arg], caller);
+
+				if (ASTRETURN_NONE != site.first && sites.end() == std::find(sites.begin(), sites.end(), site))
+					sites.push_back(site);
+			}
+
+			const StrRef name = symbols.getName(tree.info(param).symbol);
+			const StrRef defunName = symbols.getName(tree.info(defun).symbol);
+			fprintf(f, "type conflict: param %.*s of %.*s is", int(name.len), name.ptr, int(defunName.len), defunName.ptr);
+
+			for (size_t i = 0; i < sites.size(); ++i) {
+				fprintf(f, "%s %s at a call from ", i ? "," : "", stringFromReturnType(sites[i].first));
+
+				if (sites[i].second) {
+					const StrRef callerName = symbols.getName(tree.info(sites[i].second).symbol);
+					fprintf(f, "%.*s", int(callerName.len), callerName.ptr);
+				}
+				else
+					fprintf(f, "top level");
+			}
+
+			fprintf(f, "\n");
+			count++;
+		}
+	}
+
+	return count;
+}
+
+// set the return types of all nodes but literals to the inferred ones; nodes never evaluated keep the types assigned while parsing
+void TypeInference::annotate(ASTNodes& tree) const
+{
+	for (ASTNodeIndex i = 1; i < tree.size(); ++i)
+		if (ASTNODE_LITERAL != tree[i].type && ASTRETURN_NONE != types[i])
+			tree[i].rtype = types[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// compilation of (guaranteed correct) AST to bytecode, and execution of that on a stack VM; unlike eval, this leaves the AST intact
+
+// VM opcodes; code is a sequence of 32-bit words, each opcode followed by its operands as listed; var slots are relative to the frame
+// of the current function unless noted otherwise
+enum Opcode : uint32_t {
+	OP_PUSH_I32,              // literal: push literal
+	OP_PUSH_F32,              // literal: push literal
+	OP_LOAD,                  // slot: push var
+	OP_LOAD_OUTER,            // depth, slot: push var from the innermost frame of the function of the given lexical depth
+	OP_STORE,                 // slot: pop into var
+	OP_POP,                   // drop top
+	OP_ADD,                   // replace top two with the result of the arithmetic
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_ADD_I32,               // literal: replace top with the result of the arithmetic with an i32 literal
+	OP_SUB_I32,
+	OP_ADD_LOAD_I32,          // slot, literal: push the result of the arithmetic of var and i32 literal
+	OP_SUB_LOAD_I32,
+	OP_ADD_LOAD_LOAD,         // slot, slot: push the sum of two vars
+	OP_JUMP,                  // target
+	OP_JUMP_NZ,               // target: pop; jump if not zero
+	OP_JUMP_NNEG,             // target: pop; jump if not negative
+	OP_JUMP_NZ_LOAD,          // slot, target: jump if var not zero
+	OP_JUMP_NNEG_LOAD,        // slot, target: jump if var not negative
+	OP_JUMP_NZ_SUB_LOAD_I32,  // slot, literal, target: jump if the difference of var and i32 literal is not zero
+	OP_JUMP_NNEG_SUB_LOAD_I32,// slot, literal, target: jump if the difference of var and i32 literal is not negative
+	OP_IADD,                  // same as the respective ops above, for operands statically known to be i32
+	OP_ISUB,
+	OP_IMUL,
+	OP_IDIV,
+	OP_IADD_I32,
+	OP_ISUB_I32,
+	OP_IADD_LOAD_I32,
+	OP_ISUB_LOAD_I32,
+	OP_IADD_LOAD_LOAD,
+	OP_IJUMP_NZ,
+	OP_IJUMP_NNEG,
+	OP_IJUMP_NZ_LOAD,
+	OP_IJUMP_NNEG_LOAD,
+	OP_IJUMP_NZ_SUB_LOAD_I32,
+	OP_IJUMP_NNEG_SUB_LOAD_I32,
+	OP_FADD,                  // same as the respective ops above, for operands statically known to be f32
+	OP_FSUB,
+	OP_FMUL,
+	OP_FDIV,
+	OP_FJUMP_NZ,
+	OP_FJUMP_NNEG,
+	OP_ITOF,                  // convert top from i32 to f32
+	OP_PRINT,                 // print top
+	OP_READ_I32,              // push a value read from input
+	OP_READ_F32,
+	OP_CALL,                  // target, count: call function with the given count of args on top; those become its leading vars
+	OP_TAILCALL,              // target, count: same, in place of the current function, which is not visible to the callee
+	OP_ENTER,                 // locals, extent, depth: set up the frame of a function past its args
+	OP_ENTER_DISPLAY,         // locals, extent, depth: same, and make the frame the innermost one at its lexical depth
+	OP_RET,                   // return top
+	OP_HALT,                  // stop with top as result
+
+	OP_COUNT
+};
+
+// bytecode of a program -- functions are compiled from the specializations of their 'defun' nodes on first call, top-level
+// expressions as root functions; a function frame holds the args, followed by the vars of all 'let' expressions of the function,
+// followed by operands; operations on values of static types skip the checks of types
+struct Bytecode {
+	// compiled 'defun'
+	struct Function {
+		uint32_t enter; // address of 'enter' instruction
+		uint32_t depth; // lexical depth
+	};
+
+	std::pmr::vector<uint32_t>     code;
+	std::pmr::vector<uint32_t>     addr;      // per AST node: frame slot of var inits
+	std::pmr::vector<uint32_t>     entries;   // per specialization: address once compiled
+	std::pmr::vector<Function>     funcs;
+	std::pmr::vector<uint32_t>     pending;   // specializations called but not compiled yet
+	std::pmr::vector<uint32_t>     fixups;    // call sites of specializations not compiled at the time of the call
+	std::pmr::vector<bool>         displayed; // per lexical depth, frames of functions of that depth are accessed by nested functions
+	std::pmr::vector<ASTReturnType> sig;      // arg types of the call being compiled
+	Specializer                    types;
+
+	uint32_t compile(const ASTNodeIndex index, const ASTNodes& tree);
+
+private:
+	// state of the function being compiled
+	uint32_t depth;     // lexical depth of function
+	uint32_t locals;    // count of frame slots taken by vars at the current point of compilation
+	uint32_t maxLocals;
+	uint32_t maxStack;  // max count of operands
+
+	void emit(const uint32_t word) { code.push_back(word); }
+	void push(const uint32_t stack) { maxStack = stack + 1 > maxStack ? stack + 1 : maxStack; }
+	uint32_t getLocalSlot(const ASTNodeIndex index, const ASTNodes& tree) const;
+	ASTReturnType getType(const ASTNodeIndex index) const { return types.types[index]; }
+	void setDisplayed(const uint32_t depth);
+	void compileFunction(const uint32_t spec, const ASTNodes& tree);
+	void compileExpr(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree);
+	void compileLet(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree);
+	void compileArith(const ASTNodeIndex index, const uint32_t stack, const ASTNodes& tree);
+	void compileIf(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree);
+	void compileCall(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree);
+};
+
+const uint32_t addr_none = uint32_t(-1);
+const uint32_t addr_pending = uint32_t(-2);
+
+// compile a top-level expression, or the root of all, along with all defuns it calls; return its address; top-level defuns
+// preceding the expression are compiled ahead of it, so that the code of an expression that nests no defuns comes last and can
+// be dropped once run; nested defuns are compiled after the function or the expression they nest in, as they take the frame
+// slots of its vars
+uint32_t Bytecode::compile(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	assert(nullidx != index && index < tree.size());
+	addr.resize(tree.size(), addr_none);
+	types.infer(index, tree);
+
+	// all specializations made by the inference of types are of defuns the expression calls, directly or not
+	const uint32_t from = entries.size();
+	entries.resize(types.specs.size(), addr_none);
+
+	for (uint32_t spec = from; spec < entries.size(); ++spec)
+		if (types.specs[spec].defun < index && 0 == tree.info(types.specs[spec].defun).parent) {
+			entries[spec] = addr_pending;
+			pending.push_back(spec);
+		}
+
+	while (!pending.empty()) {
+		const uint32_t spec = pending.back();
+		pending.pop_back();
+		compileFunction(spec, tree);
+	}
+
+	// top-level expressions run at the bottom of the frame stack, with no args
+	types.typeRoot(index, tree);
+	const uint32_t entry = code.size();
+	depth = 0;
+	locals = 0;
+	maxLocals = 0;
+	maxStack = 0;
+
+	emit(OP_ENTER);
+	emit(0);
+	emit(0);
+	emit(0);
+	compileExpr(index, 0, false, tree);
+	emit(OP_HALT);
+
+	code[entry + 1] = maxLocals;
+	code[entry + 2] = maxLocals + maxStack;
+
+	while (!pending.empty()) {
+		const uint32_t spec = pending.back();
+		pending.pop_back();
+		compileFunction(spec, tree);
+	}
+
+	// call sites of then-pending specializations hold the specialization index in place of the target
+	for (std::pmr::vector<uint32_t>::const_iterator it = fixups.begin(); it != fixups.end(); ++it)
+		code[*it] = entries[code[*it]];
+
+	fixups.clear();
+	return entry;
+}
+
+// get the frame slot of a var evaluation if the var belongs to the function being compiled; return -1 otherwise
+uint32_t Bytecode::getLocalSlot(const ASTNodeIndex index, const ASTNodes& tree) const
+{
+	if (ASTNODE_EVAL_VAR != tree[index].type || tree[index].depth < depth)
+		return addr_none;
+
+	return addr[tree.info(index).init];
+}
+
+// have all functions of the given lexical depth make their frames the innermost ones at that depth
+void Bytecode::setDisplayed(const uint32_t depth)
+{
+	if (displayed.size() <= depth)
+		displayed.resize(depth + 1);
+
+	if (displayed[depth])
+		return;
+
+	displayed[depth] = true;
+
+	for (std::pmr::vector<Function>::const_iterator it = funcs.begin(); it != funcs.end(); ++it)
+		if (depth == it->depth)
+			code[it->enter] = OP_ENTER_DISPLAY;
+}
+
+void Bytecode::compileFunction(const uint32_t spec, const ASTNodes& tree)
+{
+	const ASTNodeIndex index = types.specs[spec].defun;
+	assert(tree[index].isDefun());
+	const uint32_t enter = code.size();
+
+	depth = tree[index].depth;
+	locals = 0;
+	maxStack = 0;
+	entries[spec] = enter;
+	types.typeFunction(spec, tree);
+	funcs.push_back(Function{ .enter = enter, .depth = depth });
+
+	// args take the leading frame slots
+	ASTNodeIndex it = tree[index].first;
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next)
+		addr[it] = locals++;
+
+	maxLocals = locals;
+
+	emit(depth < displayed.size() && displayed[depth] ? OP_ENTER_DISPLAY : OP_ENTER);
+	emit(0);
+	emit(0);
+	emit(depth);
+
+	// the last sub-expression is in tail position
+	ASTNodeIndex last = nullidx;
+	for (; nullidx != it; it = tree[it].next) {
+		if (tree[it].isDefun())
+			continue;
+
+		if (nullidx != last) {
+			compileExpr(last, 0, false, tree);
+			emit(OP_POP);
+		}
+
+		last = it;
+	}
+
+	compileExpr(last, 0, true, tree);
+	emit(OP_RET);
+
+	code[enter + 1] = maxLocals;
+	code[enter + 2] = maxLocals + maxStack;
+}
+
+// compile an expression; an expression in tail position is the last one evaluated by its function
+void Bytecode::compileExpr(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree)
+{
+	assert(nullidx != index && index < tree.size());
+	const ASTNode& node = tree[index];
+
+	switch (node.type) {
+	case ASTNODE_LET:
+		compileLet(index, stack, tail, tree);
+		break;
+	case ASTNODE_EVAL_VAR:
+		push(stack);
+
+		if (depth <= node.depth) {
+			emit(OP_LOAD);
+			emit(addr[tree.info(index).init]);
+		}
+		else {
+			// var of an enclosing function -- find the function, or the root, that the scope of the var belongs to
+			ASTNodeIndex owner = tree.info(tree.info(index).init).parent;
+			while (owner && !tree[owner].isDefun())
+				owner = tree.info(owner).parent;
+
+			setDisplayed(tree[owner].depth);
+			emit(OP_LOAD_OUTER);
+			emit(tree[owner].depth);
+			emit(addr[tree.info(index).init]);
+		}
+		break;
+	case ASTNODE_EVAL_FUN:
+		switch (node.eval) {
+		case INTRIN_PLUS:
+		case INTRIN_MINUS:
+		case INTRIN_MUL:
+		case INTRIN_DIV:
+			compileArith(index, stack, tree);
+			break;
+		case INTRIN_IFZERO:
+		case INTRIN_IFNEG:
+			compileIf(index, stack, tail, tree);
+			break;
+		case INTRIN_PRINT:
+			compileExpr(node.first, stack, false, tree);
+			emit(OP_PRINT);
+			break;
+		case INTRIN_READ_I32:
+			push(stack);
+			emit(OP_READ_I32);
+			break;
+		case INTRIN_READ_F32:
+			push(stack);
+			emit(OP_READ_F32);
+			break;
+		default:
+			compileCall(index, stack, tail, tree);
+			break;
+		}
+		break;
+	case ASTNODE_LITERAL:
+		push(stack);
+		emit(ASTRETURN_F32 == node.rtype ? OP_PUSH_F32 : OP_PUSH_I32);
+		emit(ASTRETURN_F32 == node.rtype ? bit_cast< uint32_t >(node.literal_f32) : uint32_t(node.literal_i32));
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+void Bytecode::compileLet(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree)
+{
+	// vars of the let take the next frame slots, past those of the enclosing lets; sibling lets reuse slots
+	const uint32_t base = locals;
+	locals += getSubCount(true, index, tree);
+	maxLocals = locals > maxLocals ? locals : maxLocals;
+
+	uint32_t slot = base;
+	ASTNodeIndex it = tree[index].first;
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next, ++slot) {
+		compileExpr(tree[it].first, stack, false, tree);
+		emit(OP_STORE);
+		emit(slot);
+		addr[it] = slot;
+	}
+
+	ASTNodeIndex last = nullidx;
+	for (; nullidx != it; it = tree[it].next) {
+		if (tree[it].isDefun())
+			continue;
+
+		if (nullidx != last) {
+			compileExpr(last, stack, false, tree);
+			emit(OP_POP);
+		}
+
+		last = it;
+	}
+
+	compileExpr(last, stack, tail, tree);
+	locals = base;
+}
+
+void Bytecode::compileArith(const ASTNodeIndex index, const uint32_t stack, const ASTNodes& tree)
+{
+	uint32_t op, opLiteral, opLoadLiteral, iop, iopLiteral, iopLoadLiteral, fop;
+
+	switch (tree[index].eval) {
+	case INTRIN_PLUS:
+		op = OP_ADD;
+		opLiteral = OP_ADD_I32;
+		opLoadLiteral = OP_ADD_LOAD_I32;
+		iop = OP_IADD;
+		iopLiteral = OP_IADD_I32;
+		iopLoadLiteral = OP_IADD_LOAD_I32;
+		fop = OP_FADD;
+		break;
+	case INTRIN_MINUS:
+		op = OP_SUB;
+		opLiteral = OP_SUB_I32;
+		opLoadLiteral = OP_SUB_LOAD_I32;
+		iop = OP_ISUB;
+		iopLiteral = OP_ISUB_I32;
+		iopLoadLiteral = OP_ISUB_LOAD_I32;
+		fop = OP_FSUB;
+		break;
+	case INTRIN_MUL:
+		op = OP_MUL;
+		opLiteral = OP_COUNT;
+		opLoadLiteral = OP_COUNT;
+		iop = OP_IMUL;
+		iopLiteral = OP_COUNT;
+		iopLoadLiteral = OP_COUNT;
+		fop = OP_FMUL;
+		break;
+	default:
+		op = OP_DIV;
+		opLiteral = OP_COUNT;
+		opLoadLiteral = OP_COUNT;
+		iop = OP_IDIV;
+		iopLiteral = OP_COUNT;
+		iopLoadLiteral = OP_COUNT;
+		fop = OP_FDIV;
+		break;
+	}
+
+	// arithmetic intrinsics have at least two args; a leading pair of a local var and an i32 literal, or of local vars in a sum,
+	// combines with the load of the var
+	const ASTNodeIndex first = tree[index].first;
+	const ASTNodeIndex second = tree[first].next;
+	const uint32_t slot = getLocalSlot(first, tree);
+	ASTNodeIndex it = second;
+	ASTReturnType acc = getType(first);
+
+	push(stack);
+
+	if (addr_none != slot && OP_COUNT != opLoadLiteral && ASTNODE_LITERAL == tree[second].type && ASTRETURN_I32 == tree[second].rtype) {
+		emit(ASTRETURN_I32 == acc ? iopLoadLiteral : opLoadLiteral);
+		emit(slot);
+		emit(uint32_t(tree[second].literal_i32));
+		acc = getArithType(acc, ASTRETURN_I32);
+		it = tree[second].next;
+	}
+	else
+	if (addr_none != slot && OP_ADD == op && addr_none != getLocalSlot(second, tree)) {
+		emit(ASTRETURN_I32 == acc && ASTRETURN_I32 == getType(second) ? OP_IADD_LOAD_LOAD : OP_ADD_LOAD_LOAD);
+		emit(slot);
+		emit(getLocalSlot(second, tree));
+		acc = getArithType(acc, getType(second));
+		it = tree[second].next;
+	}
+	else
+		compileExpr(first, stack, false, tree);
+
+	// the rest of the args fold into the result left to right; where the types of both operands are static, the i32 one of a mixed
+	// pair is converted beforehand
+	for (; nullidx != it; it = tree[it].next) {
+		const ASTReturnType arg = getType(it);
+
+		if (OP_COUNT != opLiteral && ASTNODE_LITERAL == tree[it].type && ASTRETURN_I32 == tree[it].rtype) {
+			emit(ASTRETURN_I32 == acc ? iopLiteral : opLiteral);
+			emit(uint32_t(tree[it].literal_i32));
+		}
+		else
+		if ((ASTRETURN_I32 == acc || ASTRETURN_F32 == acc) && (ASTRETURN_I32 == arg || ASTRETURN_F32 == arg)) {
+			if (ASTRETURN_I32 == acc && ASTRETURN_F32 == arg)
+				emit(OP_ITOF);
+
+			compileExpr(it, stack + 1, false, tree);
+
+			if (ASTRETURN_F32 == acc && ASTRETURN_I32 == arg)
+				emit(OP_ITOF);
+
+			emit(ASTRETURN_I32 == acc && ASTRETURN_I32 == arg ? iop : fop);
+		}
+		else {
+			compileExpr(it, stack + 1, false, tree);
+			emit(op);
+		}
+
+		acc = getArithType(acc, arg);
+	}
+}
+
+void Bytecode::compileIf(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree)
+{
+	const bool ifzero = INTRIN_IFZERO == tree[index].eval;
+	const ASTNodeIndex pred = tree[index].first;
+	const ASTNodeIndex branchTrue = tree[pred].next;
+	const ASTNodeIndex branchFalse = tree[branchTrue].next;
+
+	// a predicate of a local var, or of the difference of a local var and an i32 literal, combines with the branch
+	const uint32_t slot = getLocalSlot(pred, tree);
+	const ASTNode& predNode = tree[pred];
+	const bool i32 = ASTRETURN_I32 == getType(pred);
+
+	if (addr_none != slot) {
+		emit(ifzero ? (i32 ? OP_IJUMP_NZ_LOAD : OP_JUMP_NZ_LOAD) : (i32 ? OP_IJUMP_NNEG_LOAD : OP_JUMP_NNEG_LOAD));
+		emit(slot);
+	}
+	else
+	if (ASTNODE_EVAL_FUN == predNode.type && INTRIN_MINUS == predNode.eval && addr_none != getLocalSlot(predNode.first, tree) &&
+		ASTNODE_LITERAL == tree[tree[predNode.first].next].type && ASTRETURN_I32 == tree[tree[predNode.first].next].rtype &&
+		nullidx == tree[tree[predNode.first].next].next) {
+
+		emit(ifzero ? (i32 ? OP_IJUMP_NZ_SUB_LOAD_I32 : OP_JUMP_NZ_SUB_LOAD_I32) : (i32 ? OP_IJUMP_NNEG_SUB_LOAD_I32 : OP_JUMP_NNEG_SUB_LOAD_I32));
+		emit(getLocalSlot(predNode.first, tree));
+		emit(uint32_t(tree[tree[predNode.first].next].literal_i32));
+	}
+	else {
+		const bool f32 = ASTRETURN_F32 == getType(pred);
+		compileExpr(pred, stack, false, tree);
+		emit(ifzero ? (i32 ? OP_IJUMP_NZ : f32 ? OP_FJUMP_NZ : OP_JUMP_NZ) : (i32 ? OP_IJUMP_NNEG : f32 ? OP_FJUMP_NNEG : OP_JUMP_NNEG));
+	}
+
+	const uint32_t jumpFalse = code.size();
+	emit(0);
+
+	compileExpr(branchTrue, stack, tail, tree);
+	emit(OP_JUMP);
+	const uint32_t jumpEnd = code.size();
+	emit(0);
+
+	code[jumpFalse] = code.size();
+	compileExpr(branchFalse, stack, tail, tree);
+	code[jumpEnd] = code.size();
+}
+
+// compile a defun call, bound to the specialization for the static types of the args; a call in tail position replaces the current
+// function, unless the callee is nested in that
+void Bytecode::compileCall(const ASTNodeIndex index, const uint32_t stack, const bool tail, const ASTNodes& tree)
+{
+	const ASTNodeIndex defun = tree[index].eval;
+	uint32_t count = 0;
+
+	push(stack);
+
+	for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next, ++count)
+		compileExpr(it, stack + count, false, tree);
+
+	sig.clear();
+
+	for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next)
+		sig.push_back(getType(it));
+
+	// all specializations were made by the inference of types
+	const size_t specCount = types.specs.size();
+	const uint32_t spec = types.getSpec(defun, sig.data(), count);
+	assert(specCount == types.specs.size());
+	(void) specCount;
+
+	if (addr_none == entries[spec]) {
+		entries[spec] = addr_pending;
+		pending.push_back(spec);
+	}
+
+	emit(tail && tree[defun].depth <= depth ? OP_TAILCALL : OP_CALL);
+
+	if (addr_pending == entries[spec]) {
+		fixups.push_back(code.size());
+		emit(spec);
+	}
+	else
+		emit(entries[spec]);
+
+	emit(count);
+}
+
+// VM stack -- frames of active functions, each followed by its operands, and a record per active call
+struct VMStack {
+	struct Call {
+		uint32_t ip;    // return address
+		uint32_t depth; // lexical depth of the callee if its frame is in the display; -1 otherwise
+		size_t   fp;    // frame of the caller
+		size_t   prev;  // display entry of the callee depth before the call
+	};
+
+	std::pmr::vector< Value >  slots;
+	std::pmr::vector< Call >   calls;
+	std::pmr::vector< size_t > display; // per lexical depth, the innermost active frame of a function of that depth
+};
+
+// dispatch is threaded via computed goto where supported, via a switch otherwise
+#if __GNUC__
+#define VM_OP(op) label_##op
+#define VM_NEXT() goto *labels[*ip]
+#else
+#define VM_OP(op) case op
+#define VM_NEXT() goto dispatch
+#endif
+
+// execute bytecode from an address until halt; return the result
+Value execute(const Bytecode& bytecode, const uint32_t entry, VMStack& stack)
+{
+	const uint32_t* const code = bytecode.code.data();
+	const uint32_t* ip = code + entry;
+
+	if (stack.slots.empty())
+		stack.slots.resize(1024);
+
+	if (stack.display.size() < bytecode.displayed.size())
+		stack.display.resize(bytecode.displayed.size());
+
+	Value* base = stack.slots.data();
+	Value* fp = base;
+	Value* sp = base;
+
+#if __GNUC__
+	static void* const labels[] = {
+		&&label_OP_PUSH_I32,
+		&&label_OP_PUSH_F32,
+		&&label_OP_LOAD,
+		&&label_OP_LOAD_OUTER,
+		&&label_OP_STORE,
+		&&label_OP_POP,
+		&&label_OP_ADD,
+		&&label_OP_SUB,
+		&&label_OP_MUL,
+		&&label_OP_DIV,
+		&&label_OP_ADD_I32,
+		&&label_OP_SUB_I32,
+		&&label_OP_ADD_LOAD_I32,
+		&&label_OP_SUB_LOAD_I32,
+		&&label_OP_ADD_LOAD_LOAD,
+		&&label_OP_JUMP,
+		&&label_OP_JUMP_NZ,
+		&&label_OP_JUMP_NNEG,
+		&&label_OP_JUMP_NZ_LOAD,
+		&&label_OP_JUMP_NNEG_LOAD,
+		&&label_OP_JUMP_NZ_SUB_LOAD_I32,
+		&&label_OP_JUMP_NNEG_SUB_LOAD_I32,
+		&&label_OP_IADD,
+		&&label_OP_ISUB,
+		&&label_OP_IMUL,
+		&&label_OP_IDIV,
+		&&label_OP_IADD_I32,
+		&&label_OP_ISUB_I32,
+		&&label_OP_IADD_LOAD_I32,
+		&&label_OP_ISUB_LOAD_I32,
+		&&label_OP_IADD_LOAD_LOAD,
+		&&label_OP_IJUMP_NZ,
+		&&label_OP_IJUMP_NNEG,
+		&&label_OP_IJUMP_NZ_LOAD,
+		&&label_OP_IJUMP_NNEG_LOAD,
+		&&label_OP_IJUMP_NZ_SUB_LOAD_I32,
+		&&label_OP_IJUMP_NNEG_SUB_LOAD_I32,
+		&&label_OP_FADD,
+		&&label_OP_FSUB,
+		&&label_OP_FMUL,
+		&&label_OP_FDIV,
+		&&label_OP_FJUMP_NZ,
+		&&label_OP_FJUMP_NNEG,
+		&&label_OP_ITOF,
+		&&label_OP_PRINT,
+		&&label_OP_READ_I32,
+		&&label_OP_READ_F32,
+		&&label_OP_CALL,
+		&&label_OP_TAILCALL,
+		&&label_OP_ENTER,
+		&&label_OP_ENTER_DISPLAY,
+		&&label_OP_RET,
+		&&label_OP_HALT
+	};
+	static_assert(countof(labels) == OP_COUNT, "every opcode needs a label");
+
+	VM_NEXT();
+
+#else
+dispatch:
+	switch (*ip) {
+#endif
+	VM_OP(OP_PUSH_I32):
+		*sp++ = Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[1]) };
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_PUSH_F32):
+		*sp++ = Value{ .type = ASTRETURN_F32, .f32 = bit_cast< float >(ip[1]) };
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_LOAD):
+		*sp++ = fp[ip[1]];
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_LOAD_OUTER):
+		*sp++ = base[stack.display[ip[1]] + ip[2]];
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_STORE):
+		fp[ip[1]] = *--sp;
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_POP):
+		sp--;
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_ADD):
+		sp--;
+		sp[-1] = applyArith< binop_plus< int32_t >, binop_plus< float > >(sp[-1], sp[0]);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_SUB):
+		sp--;
+		sp[-1] = applyArith< binop_minus< int32_t >, binop_minus< float > >(sp[-1], sp[0]);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_MUL):
+		sp--;
+		sp[-1] = applyArith< binop_mul< int32_t >, binop_mul< float > >(sp[-1], sp[0]);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_DIV):
+		sp--;
+		sp[-1] = applyArith< binop_div< int32_t >, binop_div< float > >(sp[-1], sp[0]);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_ADD_I32):
+		sp[-1] = applyArith< binop_plus< int32_t >, binop_plus< float > >(sp[-1], Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[1]) });
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_SUB_I32):
+		sp[-1] = applyArith< binop_minus< int32_t >, binop_minus< float > >(sp[-1], Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[1]) });
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_ADD_LOAD_I32):
+		*sp++ = applyArith< binop_plus< int32_t >, binop_plus< float > >(fp[ip[1]], Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[2]) });
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_SUB_LOAD_I32):
+		*sp++ = applyArith< binop_minus< int32_t >, binop_minus< float > >(fp[ip[1]], Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[2]) });
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_ADD_LOAD_LOAD):
+		*sp++ = applyArith< binop_plus< int32_t >, binop_plus< float > >(fp[ip[1]], fp[ip[2]]);
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_JUMP):
+		ip = code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NZ):
+		ip = applyPred< predop_eq< int32_t >, predop_eq< float > >(*--sp) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NNEG):
+		ip = applyPred< predop_gt< int32_t >, predop_gt< float > >(*--sp) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NZ_LOAD):
+		ip = applyPred< predop_eq< int32_t >, predop_eq< float > >(fp[ip[1]]) ? ip + 3 : code + ip[2];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NNEG_LOAD):
+		ip = applyPred< predop_gt< int32_t >, predop_gt< float > >(fp[ip[1]]) ? ip + 3 : code + ip[2];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NZ_SUB_LOAD_I32):
+		ip = applyPred< predop_eq< int32_t >, predop_eq< float > >(applyArith< binop_minus< int32_t >, binop_minus< float > >(fp[ip[1]],
+			Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[2]) })) ? ip + 4 : code + ip[3];
+		VM_NEXT();
+	VM_OP(OP_JUMP_NNEG_SUB_LOAD_I32):
+		ip = applyPred< predop_gt< int32_t >, predop_gt< float > >(applyArith< binop_minus< int32_t >, binop_minus< float > >(fp[ip[1]],
+			Value{ .type = ASTRETURN_I32, .i32 = int32_t(ip[2]) })) ? ip + 4 : code + ip[3];
+		VM_NEXT();
+	VM_OP(OP_IADD):
+		sp--;
+		sp[-1].i32 = binop_plus< int32_t >(sp[-1].i32, sp[0].i32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_ISUB):
+		sp--;
+		sp[-1].i32 = binop_minus< int32_t >(sp[-1].i32, sp[0].i32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_IMUL):
+		sp--;
+		sp[-1].i32 = binop_mul< int32_t >(sp[-1].i32, sp[0].i32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_IDIV):
+		sp--;
+		sp[-1].i32 = binop_div< int32_t >(sp[-1].i32, sp[0].i32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_IADD_I32):
+		sp[-1].i32 = binop_plus< int32_t >(sp[-1].i32, int32_t(ip[1]));
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_ISUB_I32):
+		sp[-1].i32 = binop_minus< int32_t >(sp[-1].i32, int32_t(ip[1]));
+		ip += 2;
+		VM_NEXT();
+	VM_OP(OP_IADD_LOAD_I32):
+		*sp++ = Value{ .type = ASTRETURN_I32, .i32 = binop_plus< int32_t >(fp[ip[1]].i32, int32_t(ip[2])) };
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_ISUB_LOAD_I32):
+		*sp++ = Value{ .type = ASTRETURN_I32, .i32 = binop_minus< int32_t >(fp[ip[1]].i32, int32_t(ip[2])) };
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_IADD_LOAD_LOAD):
+		*sp++ = Value{ .type = ASTRETURN_I32, .i32 = binop_plus< int32_t >(fp[ip[1]].i32, fp[ip[2]].i32) };
+		ip += 3;
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NZ):
+		ip = predop_eq< int32_t >(0, (--sp)->i32) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NNEG):
+		ip = predop_gt< int32_t >(0, (--sp)->i32) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NZ_LOAD):
+		ip = predop_eq< int32_t >(0, fp[ip[1]].i32) ? ip + 3 : code + ip[2];
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NNEG_LOAD):
+		ip = predop_gt< int32_t >(0, fp[ip[1]].i32) ? ip + 3 : code + ip[2];
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NZ_SUB_LOAD_I32):
+		ip = predop_eq< int32_t >(0, binop_minus< int32_t >(fp[ip[1]].i32, int32_t(ip[2]))) ? ip + 4 : code + ip[3];
+		VM_NEXT();
+	VM_OP(OP_IJUMP_NNEG_SUB_LOAD_I32):
+		ip = predop_gt< int32_t >(0, binop_minus< int32_t >(fp[ip[1]].i32, int32_t(ip[2]))) ? ip + 4 : code + ip[3];
+		VM_NEXT();
+	VM_OP(OP_FADD):
+		sp--;
+		sp[-1].f32 = binop_plus< float >(sp[-1].f32, sp[0].f32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_FSUB):
+		sp--;
+		sp[-1].f32 = binop_minus< float >(sp[-1].f32, sp[0].f32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_FMUL):
+		sp--;
+		sp[-1].f32 = binop_mul< float >(sp[-1].f32, sp[0].f32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_FDIV):
+		sp--;
+		sp[-1].f32 = binop_div< float >(sp[-1].f32, sp[0].f32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_FJUMP_NZ):
+		ip = predop_eq< float >(0.f, (--sp)->f32) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_FJUMP_NNEG):
+		ip = predop_gt< float >(0.f, (--sp)->f32) ? ip + 2 : code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_ITOF):
+		sp[-1] = Value{ .type = ASTRETURN_F32, .f32 = float(sp[-1].i32) };
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_PRINT):
+		if (ASTRETURN_F32 == sp[-1].type)
+			fprintf(stdout, "%f\n", sp[-1].f32);
+		else
+			fprintf(stdout, "%d\n", sp[-1].i32);
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_READ_I32):
+		*sp++ = Value{ .type = ASTRETURN_I32, .i32 = read<int32_t>("i: ", "%d") };
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_READ_F32):
+		*sp++ = Value{ .type = ASTRETURN_F32, .f32 = read<float>("f: ", "%f") };
+		ip += 1;
+		VM_NEXT();
+	VM_OP(OP_CALL):
+		stack.calls.push_back(VMStack::Call{ .ip = uint32_t(ip + 3 - code), .depth = uint32_t(-1), .fp = size_t(fp - base) });
+		fp = sp - ip[2];
+		ip = code + ip[1];
+		VM_NEXT();
+	VM_OP(OP_TAILCALL):
+		{
+			// the callee takes over the frame of the current function, and the record of its call
+			VMStack::Call& call = stack.calls.back();
+
+			if (uint32_t(-1) != call.depth) {
+				stack.display[call.depth] = call.prev;
+				call.depth = uint32_t(-1);
+			}
+
+			const uint32_t count = ip[2];
+			const Value* const args = sp - count;
+			for (uint32_t i = 0; i < count; ++i)
+				fp[i] = args[i];
+
+			sp = fp + count;
+			ip = code + ip[1];
+		}
+		VM_NEXT();
+	VM_OP(OP_ENTER_DISPLAY):
+		{
+			VMStack::Call& call = stack.calls.back();
+			call.depth = ip[3];
+			call.prev = stack.display[ip[3]];
+			stack.display[ip[3]] = fp - base;
+		}
+		// fall through
+	VM_OP(OP_ENTER):
+		// the frame and its operands must fit in the stack
+		if (stack.slots.size() < size_t(fp - base) + ip[2]) {
+			const size_t pos = fp - base;
+			stack.slots.resize((pos + ip[2]) * 2);
+			base = stack.slots.data();
+			fp = base + pos;
+		}
+
+		sp = fp + ip[1];
+		ip += 4;
+		VM_NEXT();
+	VM_OP(OP_RET):
+		{
+			const VMStack::Call& call = stack.calls.back();
+
+			if (uint32_t(-1) != call.depth)
+				stack.display[call.depth] = call.prev;
+
+			*fp = sp[-1];
+			sp = fp + 1;
+			fp = base + call.fp;
+			ip = code + call.ip;
+			stack.calls.pop_back();
+		}
+		VM_NEXT();
+	VM_OP(OP_HALT):
+		assert(stack.calls.empty());
+		return sp[-1];
+#if !__GNUC__
+	}
+
+	assert(false);
+	return Value{ .type = ASTRETURN_NONE };
+#endif
+}
+
+#undef VM_OP
+#undef VM_NEXT
+
+////////////////////////////////////////////////////////////////////////////////
+// compilation of type-stable defuns to x86-64 machine code, called by plain evaluation in place of evaluating their bodies
+
+// native code of a defun is specialized by the types of its args, as typed by the specializer; every expression in it must be of a
+// single type given those, i32 values being kept in GPRs and f32 values in SSE scalar registers; defuns that do i/o, read vars of
+// scopes enclosing them, or call defuns that do not compile are left to the interpreter
+//
+// native calling convention: args are pushed in order as 64-bit slots, the callee sets up a frame over them and returns its result
+// in eax or xmm0, and the caller pops the args; native code runs on a stack of its own, switched to by an entry stub
+enum JitState : uint8_t {
+	JIT_NEW,     // not compiled yet
+	JIT_PENDING, // being compiled
+	JIT_DONE,    // compiled
+	JIT_FAILED   // left to the interpreter
+};
+
+struct Jit {
+	// native code of a specialization
+	struct Code {
+		uint32_t locals; // count of frame slots past the args
+		uint32_t entry;  // offset of code in the code region
+		JitState state;
+	};
+
+	std::pmr::vector<Code>          codes;  // per specialization
+	std::pmr::vector<uint32_t>      slots;  // per AST node: frame slot of var inits of the function being compiled
+	std::pmr::vector<ASTReturnType> sig;    // arg types of the call being compiled
+	std::pmr::vector<uint32_t>      group;  // specializations compiled together, as they call one another
+	std::pmr::vector<uint8_t>       code;   // code of the group
+	std::pmr::vector< std::pair< uint32_t, uint32_t > > fixups; // call sites in the code of the group, as (rel32 offset, callee)
+	Specializer                     types;
+
+	const SymbolTable* symbols = nullptr; // for naming code in the perf map
+	uint8_t* region = nullptr;            // code region
+	uint8_t* stack = nullptr;             // native stack
+	FILE*    perfMap = nullptr;
+	size_t   used = 0;                    // bytes of the code region taken
+	size_t   doneCount = 0;
+	size_t   failedCount = 0;
+
+	static const size_t regionSize = size_t(1) << 26;
+	static const size_t stackSize = size_t(1) << 28;
+
+	~Jit();
+
+	bool init();
+	bool call(const ASTNodeIndex defun, const Value* args, const size_t count, const ASTNodes& tree, Value& ret);
+
+private:
+	// state of the function being compiled
+	uint32_t cur;       // specialization
+	uint32_t arity;
+	uint32_t nslots;    // count of frame slots taken at the current point of compilation
+	uint32_t maxSlots;
+	uint32_t bodyStart; // offset of code past the prologue
+	bool     emitting;  // emit code, rather than just count frame slots
+	bool     failed;
+
+	void emit(const std::initializer_list<uint8_t> bytes) { if (emitting) code.insert(code.end(), bytes); }
+	void emit32(const uint32_t word);
+	uint32_t emitJump(const std::initializer_list<uint8_t> op);
+	void patch(const uint32_t at, const uint32_t target);
+	void emitLoad(const ASTNodeIndex init);
+	void emitStore(const ASTNodeIndex init);
+	void emitPush(const ASTReturnType type);
+	int32_t getDisp(const uint32_t slot) const;
+	ASTReturnType getType(const ASTNodeIndex index) const { return types.types[index]; }
+	bool place();
+	bool compile(const uint32_t entry, const ASTNodes& tree);
+	void writePerfMap(const uint32_t spec, const size_t size, const ASTNodes& tree);
+	void genFunction(const uint32_t spec, const ASTNodes& tree);
+	void genBody(ASTNodeIndex it, const bool tail, const ASTNodes& tree);
+	void genExpr(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	void genLet(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	void genArith(const ASTNodeIndex index, const ASTNodes& tree);
+	void genIf(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	void genCall(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+};
+
+// entry stub: void enter(const uint64_t* args, size_t count, const void* fn, void* stackTop, uint64_t out[2]) -- push args on the
+// native stack and call fn, storing rax and xmm0 past the call
+const uint8_t jitEnter[] = {
+	0x55,                               // push rbp
+	0x48, 0x89, 0xe5,                   // mov rbp, rsp
+	0x41, 0x50,                         // push r8
+	0x48, 0x89, 0xcc,                   // mov rsp, rcx
+	0x48, 0x85, 0xf6,                   // test rsi, rsi
+	0x74, 0x0b,                         // jz done
+	0xff, 0x37,                         // loop: push qword [rdi]
+	0x48, 0x83, 0xc7, 0x08,             // add rdi, 8
+	0x48, 0xff, 0xce,                   // dec rsi
+	0x75, 0xf5,                         // jnz loop
+	0xff, 0xd2,                         // done: call rdx
+	0x4c, 0x8b, 0x45, 0xf8,             // mov r8, [rbp - 8]
+	0x49, 0x89, 0x00,                   // mov [r8], rax
+	0x66, 0x41, 0x0f, 0xd6, 0x40, 0x08, // movq [r8 + 8], xmm0
+	0xc9,                               // leave
+	0xc3                                // ret
+};
+
+typedef void (*JitEnter)(const uint64_t* args, size_t count, const void* fn, void* stackTop, uint64_t* out);
+
+Jit::~Jit()
+{
+	if (nullptr != region)
+		munmap(region, regionSize);
+
+	if (nullptr != stack)
+		munmap(stack, stackSize);
+
+	if (nullptr != perfMap)
+		fclose(perfMap);
+}
+
+// reserve the code region and the native stack, and open the perf map; return false if native code is not an option
+bool Jit::init()
+{
+#if __x86_64__
+	void* const code = mmap(nullptr, regionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if (MAP_FAILED == code)
+		return false;
+
+	void* const stk = mmap(nullptr, stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if (MAP_FAILED == stk) {
+		munmap(code, regionSize);
+		return false;
+	}
+
+	region = static_cast< uint8_t* >(code);
+	stack = static_cast< uint8_t* >(stk);
+
+	// overflow of the native stack faults rather than run into other mappings
+	mprotect(stack, getpagesize(), PROT_NONE);
+
+	char name[64];
+	snprintf(name, sizeof(name), "/tmp/perf-%d.map", int(getpid()));
+	perfMap = fopen(name, "w");
+
+	this->code.assign(jitEnter, jitEnter + sizeof(jitEnter));
+
+	if (!place())
+		return false;
+
+	if (nullptr != perfMap)
+		fprintf(perfMap, "%lx %zx tinl:enter\n", uintptr_t(region), sizeof(jitEnter));
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// call a defun natively, compiling it for the types of the given args on first call; return false if left to the interpreter
+bool Jit::call(const ASTNodeIndex defun, const Value* args, const size_t count, const ASTNodes& tree, Value& ret)
+{
+	if (nullptr == region || 64 < count)
+		return false;
+
+	sig.clear();
+
+	for (size_t i = 0; i < count; ++i)
+		sig.push_back(args[i].type);
+
+	// a specialization new to the specializer is typed along with all it calls for; those typed before are final
+	types.init(tree);
+	const uint32_t from = types.specs.size();
+	const uint32_t spec = types.getSpec(defun, sig.data(), count);
+
+	if (from != types.specs.size()) {
+		types.settle(from, nullidx, tree);
+		codes.resize(types.specs.size(), Code{ .locals = 0, .entry = 0, .state = JIT_NEW });
+	}
+
+	if (JIT_NEW == codes[spec].state)
+		compile(spec, tree);
+
+	if (JIT_DONE != codes[spec].state)
+		return false;
+
+	uint64_t slots[64];
+	uint64_t out[2];
+
+	for (size_t i = 0; i < count; ++i)
+		slots[i] = uint32_t(args[i].i32);
+
+	reinterpret_cast< JitEnter >(region)(slots, count, region + codes[spec].entry, stack + stackSize, out);
+
+	ret = ASTRETURN_F32 == types.specs[spec].rtype
+		? Value{ .type = ASTRETURN_F32, .f32 = bit_cast< float >(uint32_t(out[1])) }
+		: Value{ .type = ASTRETURN_I32, .i32 = int32_t(out[0]) };
+	return true;
+}
+
+void Jit::emit32(const uint32_t word)
+{
+	if (emitting)
+		for (size_t i = 0; i < 4; ++i)
+			code.push_back(uint8_t(word >> i * 8));
+}
+
+// emit a jump of the given opcode with a rel32 to patch; return the offset of the rel32
+uint32_t Jit::emitJump(const std::initializer_list<uint8_t> op)
+{
+	emit(op);
+	const uint32_t at = code.size();
+	emit32(0);
+	return at;
+}
+
+void Jit::patch(const uint32_t at, const uint32_t target)
+{
+	if (!emitting)
+		return;
+
+	const int32_t rel = int32_t(target - (at + 4));
+	memcpy(code.data() + at, &rel, sizeof(rel));
+}
+
+// get the frame offset of a slot -- args are above the saved rbp and return address, vars of 'let' expressions below
+int32_t Jit::getDisp(const uint32_t slot) const
+{
+	return slot < arity ? 16 + 8 * int32_t(arity - 1 - slot) : -8 * int32_t(slot - arity + 1);
+}
+
+void Jit::emitLoad(const ASTNodeIndex init)
+{
+	if (ASTRETURN_F32 == getType(init))
+		emit({ 0xf3, 0x0f, 0x10, 0x85 }); // movss xmm0, [rbp + disp32]
+	else
+		emit({ 0x8b, 0x85 });             // mov eax, [rbp + disp32]
+
+	emit32(getDisp(slots[init]));
+}
+
+void Jit::emitStore(const ASTNodeIndex init)
+{
+	if (ASTRETURN_F32 == getType(init))
+		emit({ 0xf3, 0x0f, 0x11, 0x85 }); // movss [rbp + disp32], xmm0
+	else
+		emit({ 0x89, 0x85 });             // mov [rbp + disp32], eax
+
+	emit32(getDisp(slots[init]));
+}
+
+void Jit::emitPush(const ASTReturnType type)
+{
+	if (ASTRETURN_F32 == type)
+		emit({ 0x66, 0x0f, 0x7e, 0xc0 }); // movd eax, xmm0
+
+	emit({ 0x50 });                       // push rax
+}
+
+// copy the code of the group past the taken part of the code region and resolve its calls; return false if the region is full
+bool Jit::place()
+{
+	const size_t page = getpagesize();
+	const size_t begin = used & ~(page - 1);
+	const size_t end = (used + code.size() + page - 1) & ~(page - 1);
+
+	if (regionSize < end)
+		return false;
+
+	if (0 != mprotect(region + begin, end - begin, PROT_READ | PROT_WRITE))
+		return false;
+
+	memcpy(region + used, code.data(), code.size());
+
+	for (std::pmr::vector< std::pair< uint32_t, uint32_t > >::const_iterator it = fixups.begin(); it != fixups.end(); ++it) {
+		const int32_t rel = int32_t(codes[it->second].entry - (used + it->first + 4));
+		memcpy(region + used + it->first, &rel, sizeof(rel));
+	}
+
+	mprotect(region + begin, end - begin, PROT_READ | PROT_EXEC);
+	used = (used + code.size() + 15) & ~size_t(15);
+	return true;
+}
+
+// compile a specialization along with all it calls that are not compiled yet; return false if those are left to the interpreter
+bool Jit::compile(const uint32_t entry, const ASTNodes& tree)
+{
+	if (slots.size() < tree.size())
+		slots.resize(tree.size());
+
+	group.assign(1, entry);
+	codes[entry].state = JIT_PENDING;
+	failed = false;
+	code.clear();
+	fixups.clear();
+
+	// callees not compiled yet join the group as they are met; a dry run of each function counts its frame slots ahead of the
+	// prologue, and a return type still none is of a function that never returns
+	for (size_t i = 0; i < group.size() && !failed; ++i) {
+		const ASTReturnType rtype = types.specs[group[i]].rtype;
+		failed |= ASTRETURN_I32 != rtype && ASTRETURN_F32 != rtype;
+
+		while (code.size() % 16)
+			code.push_back(0xcc);
+
+		emitting = false;
+		genFunction(group[i], tree);
+		emitting = true;
+		codes[group[i]].entry = used + code.size();
+		genFunction(group[i], tree);
+	}
+
+	if (failed || !place()) {
+		// the rest of the group may yet compile on its own
+		for (size_t i = 0; i < group.size(); ++i)
+			codes[group[i]].state = entry == group[i] ? JIT_FAILED : JIT_NEW;
+
+		failedCount++;
+		return false;
+	}
+
+	for (size_t i = 0; i < group.size(); ++i) {
+		const size_t end = i + 1 < group.size() ? codes[group[i + 1]].entry : used;
+		codes[group[i]].state = JIT_DONE;
+		writePerfMap(group[i], end - codes[group[i]].entry, tree);
+	}
+
+	doneCount += group.size();
+	return true;
+}
+
+// name the code of a specialization after its defun and arg types, for perf to symbolize native frames
+void Jit::writePerfMap(const uint32_t spec, const size_t size, const ASTNodes& tree)
+{
+	if (nullptr == perfMap)
+		return;
+
+	const Specializer::Spec& s = types.specs[spec];
+	const Symbol symbol = tree.info(s.defun).symbol;
+	const StrRef name = nullptr != symbols && nullsym != symbol ? symbols->getName(symbol) : StrRef{ .ptr = "defun", .len = 5 };
+
+	fprintf(perfMap, "%lx %zx tinl:%.*s(", uintptr_t(region + codes[spec].entry), size, int(name.len), name.ptr);
+
+	for (size_t i = 0; i < getSubCount(true, s.defun, tree); ++i)
+		fprintf(perfMap, i ? ",%s" : "%s", stringFromReturnType(types.sigs[s.sig + i]));
+
+	fprintf(perfMap, ")\n");
+	fflush(perfMap);
+}
+
+// emit the code of a specialization, or just count its frame slots
+void Jit::genFunction(const uint32_t spec, const ASTNodes& tree)
+{
+	cur = spec;
+	arity = 0;
+	types.typeFunction(spec, tree);
+
+	ASTNodeIndex it = tree[types.specs[spec].defun].first;
+
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next, ++arity)
+		slots[it] = arity;
+
+	nslots = arity;
+	maxSlots = arity;
+
+	emit({ 0x55 });                   // push rbp
+	emit({ 0x48, 0x89, 0xe5 });       // mov rbp, rsp
+
+	if (codes[spec].locals) {
+		emit({ 0x48, 0x81, 0xec });   // sub rsp, imm32
+		emit32(codes[spec].locals * 8);
+	}
+
+	bodyStart = code.size();
+	genBody(it, true, tree);
+
+	if (!emitting)
+		codes[spec].locals = maxSlots - arity;
+
+	emit({ 0xc9, 0xc3 });             // leave; ret
+}
+
+// generate the sub-expressions of a scope past its var inits
+void Jit::genBody(ASTNodeIndex it, const bool tail, const ASTNodes& tree)
+{
+	ASTNodeIndex last = nullidx;
+
+	for (; nullidx != it; it = tree[it].next) {
+		if (tree[it].isDefun())
+			continue;
+
+		if (nullidx != last)
+			genExpr(last, false, tree);
+
+		last = it;
+	}
+
+	assert(nullidx != last);
+	genExpr(last, tail, tree);
+}
+
+void Jit::genExpr(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const ASTNode& node = tree[index];
+
+	// values of a type up to the branch taken by an 'if' are left to the interpreter
+	if (ASTRETURN_UNKNOWN == getType(index)) {
+		failed = true;
+		return;
+	}
+
+	switch (node.type) {
+	case ASTNODE_LET:
+		genLet(index, tail, tree);
+		break;
+	case ASTNODE_EVAL_VAR:
+		if (node.depth < tree[types.specs[cur].defun].depth) {
+			failed = true;
+			break;
+		}
+
+		emitLoad(tree.info(index).init);
+		break;
+	case ASTNODE_EVAL_FUN:
+		switch (node.eval) {
+		case INTRIN_PLUS:
+		case INTRIN_MINUS:
+		case INTRIN_MUL:
+		case INTRIN_DIV:
+			genArith(index, tree);
+			break;
+		case INTRIN_IFZERO:
+		case INTRIN_IFNEG:
+			genIf(index, tail, tree);
+			break;
+		case INTRIN_PRINT:
+		case INTRIN_READ_I32:
+		case INTRIN_READ_F32:
+			failed = true;
+			break;
+		default:
+			genCall(index, tail, tree);
+			break;
+		}
+		break;
+	case ASTNODE_LITERAL:
+		emit({ 0xb8 });                            // mov eax, imm32
+		emit32(uint32_t(node.literal_i32));
+
+		if (ASTRETURN_F32 == node.rtype)
+			emit({ 0x66, 0x0f, 0x6e, 0xc0 });      // movd xmm0, eax
+		break;
+	default:
+		assert(false);
+		failed = true;
+		break;
+	}
+}
+
+void Jit::genLet(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const uint32_t mark = nslots;
+	ASTNodeIndex it = tree[index].first;
+
+	// a var takes its slot past those of its init, which may be taken by nested 'let' expressions meanwhile
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next) {
+		genExpr(tree[it].first, false, tree);
+		slots[it] = nslots++;
+		maxSlots = nslots > maxSlots ? nslots : maxSlots;
+		emitStore(it);
+	}
+
+	genBody(it, tail, tree);
+	nslots = mark;
+}
+
+void Jit::genArith(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	const ASTNodeIndex eval = tree[index].eval;
+	ASTNodeIndex it = tree[index].first;
+	ASTReturnType acc = getType(it);
+	genExpr(it, false, tree);
+
+	// arithmetic intrinsics have at least two args; the left one waits on the stack while the right one is evaluated
+	for (it = tree[it].next; nullidx != it; it = tree[it].next) {
+		const ASTReturnType type = getType(it);
+		emitPush(acc);
+		genExpr(it, false, tree);
+
+		if (ASTRETURN_NONE == acc || ASTRETURN_NONE == type) {
+			emit({ 0x58 });                            // pop rax
+			acc = ASTRETURN_NONE;
+			continue;
+		}
+		if (ASTRETURN_I32 == acc && ASTRETURN_I32 == type) {
+			emit({ 0x89, 0xc1 });                      // mov ecx, eax
+			emit({ 0x58 });                            // pop rax
+
+			switch (eval) {
+			case INTRIN_PLUS:
+				emit({ 0x01, 0xc8 });                  // add eax, ecx
+				break;
+			case INTRIN_MINUS:
+				emit({ 0x29, 0xc8 });                  // sub eax, ecx
+				break;
+			case INTRIN_MUL:
+				emit({ 0x0f, 0xaf, 0xc1 });            // imul eax, ecx
+				break;
+			default:
+				emit({ 0x99, 0xf7, 0xf9 });            // cdq; idiv ecx
+				break;
+			}
+			continue;
+		}
+
+		// mixed operands are promoted to f32
+		if (ASTRETURN_I32 == type)
+			emit({ 0xf3, 0x0f, 0x2a, 0xc8 });          // cvtsi2ss xmm1, eax
+		else
+			emit({ 0x0f, 0x28, 0xc8 });                // movaps xmm1, xmm0
+
+		emit({ 0x58 });                                // pop rax
+
+		if (ASTRETURN_I32 == acc)
+			emit({ 0xf3, 0x0f, 0x2a, 0xc0 });          // cvtsi2ss xmm0, eax
+		else
+			emit({ 0x66, 0x0f, 0x6e, 0xc0 });          // movd xmm0, eax
+
+		switch (eval) {
+		case INTRIN_PLUS:
+			emit({ 0xf3, 0x0f, 0x58, 0xc1 });          // addss xmm0, xmm1
+			break;
+		case INTRIN_MINUS:
+			emit({ 0xf3, 0x0f, 0x5c, 0xc1 });          // subss xmm0, xmm1
+			break;
+		case INTRIN_MUL:
+			emit({ 0xf3, 0x0f, 0x59, 0xc1 });          // mulss xmm0, xmm1
+			break;
+		default:
+			emit({ 0xf3, 0x0f, 0x5e, 0xc1 });          // divss xmm0, xmm1
+			break;
+		}
+
+		acc = ASTRETURN_F32;
+	}
+}
+
+// branches of different types make the 'if' of unknown type, so those never get here
+void Jit::genIf(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const bool ifzero = INTRIN_IFZERO == tree[index].eval;
+	const ASTNodeIndex pred = tree[index].first;
+	const ASTReturnType type = getType(pred);
+	genExpr(pred, false, tree);
+	uint32_t toElse[2];
+	size_t count = 0;
+
+	// jump to the else branch unless the predicate holds; f32 comparisons against nan are unordered, i.e. do not hold
+	if (ASTRETURN_F32 == type) {
+		emit({ 0x0f, 0x57, 0xc9 });                            // xorps xmm1, xmm1
+
+		if (ifzero) {
+			emit({ 0x0f, 0x2e, 0xc1 });                        // ucomiss xmm0, xmm1
+			toElse[count++] = emitJump({ 0x0f, 0x85 });        // jne
+			toElse[count++] = emitJump({ 0x0f, 0x8a });        // jp
+		}
+		else {
+			emit({ 0x0f, 0x2e, 0xc8 });                        // ucomiss xmm1, xmm0
+			toElse[count++] = emitJump({ 0x0f, 0x86 });        // jbe
+		}
+	}
+	else {
+		emit({ 0x85, 0xc0 });                                  // test eax, eax
+		toElse[count++] = emitJump({ 0x0f, uint8_t(ifzero ? 0x85 : 0x89) }); // jnz; jns
+	}
+
+	const ASTNodeIndex then = tree[pred].next;
+	genExpr(then, tail, tree);
+	const uint32_t toEnd = emitJump({ 0xe9 });                 // jmp
+
+	for (size_t i = 0; i < count; ++i)
+		patch(toElse[i], code.size());
+
+	genExpr(tree[then].next, tail, tree);
+	patch(toEnd, code.size());
+}
+
+void Jit::genCall(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const ASTNodeIndex defun = tree[index].eval;
+	uint32_t count = 0;
+	bool known = true;
+
+	for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next, ++count) {
+		genExpr(it, false, tree);
+		emitPush(getType(it));
+		known &= ASTRETURN_NONE != getType(it);
+	}
+
+	// the callee cannot be told till the types of all args are
+	if (!known) {
+		failed = true;
+		return;
+	}
+
+	sig.clear();
+
+	for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next)
+		sig.push_back(getType(it));
+
+	// all specializations were made by the specializer
+	const size_t specCount = types.specs.size();
+	const uint32_t callee = types.getSpec(defun, sig.data(), count);
+	assert(specCount == types.specs.size());
+	(void) specCount;
+
+	switch (codes[callee].state) {
+	case JIT_NEW:
+		codes[callee].state = JIT_PENDING;
+		group.push_back(callee);
+		break;
+	case JIT_FAILED:
+		failed = true;
+		return;
+	default:
+		break;
+	}
+
+	failed |= ASTRETURN_NONE == types.specs[callee].rtype;
+
+	// a call to self in tail position takes the place of the current call
+	if (tail && callee == cur) {
+		for (uint32_t i = count; i-- > 0; ) {
+			emit({ 0x58 });                   // pop rax
+			emit({ 0x89, 0x85 });             // mov [rbp + disp32], eax
+			emit32(getDisp(i));
+		}
+
+		patch(emitJump({ 0xe9 }), bodyStart); // jmp
+		return;
+	}
+
+	const uint32_t at = emitJump({ 0xe8 });   // call
+
+	if (emitting)
+		fixups.push_back(std::make_pair(at, callee));
+
+	if (count) {
+		emit({ 0x48, 0x81, 0xc4 });           // add rsp, imm32
+		emit32(count * 8);
+	}
+}
+
+// call a defun natively if possible -- a shim to the JIT for plain evaluation
+bool callNative(Jit& jit, const ASTNodeIndex defun, const Value* args, const size_t count, const ASTNodes& tree, Value& ret)
+{
+	return jit.call(defun, args, count, tree, ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// lowering of (guaranteed correct) AST to a self-contained C translation unit, for building native executables ahead of time
+
+// every expression gets a static C type given the types of the args of its defun, as typed by the specializer over the whole
+// program: int32_t, float, or a tagged value where the type is up to the branch taken by an 'if'; a defun becomes one C function per
+// combination of arg types it is called with; vars read by defuns nested in their scope are also kept in globals, saved and
+// restored around the scope as the display would have them, of the type the var takes in all functions, tagged if those disagree;
+// a function calling itself in tail position jumps back to its top in place of the call, so loops expressed as tail recursion run
+// in constant stack space whatever the C compiler does
+struct CSource {
+	// result of an expression -- a temp, a local var or a global var; or none, past a jump to the top of the function
+	struct Operand {
+		ASTReturnType type;
+		char          kind; // 't', 'v', 'g' or 'j'
+		uint32_t      id;
+	};
+
+	std::pmr::vector<bool>          captured; // per AST node: var init read by defuns nested in its scope
+	std::pmr::vector<bool>          read;     // per AST node: var init read at all; vars never read are discarded in C
+	std::pmr::vector<bool>          declared; // per AST node: captured var init of a scope that is lowered, thus of a global
+	std::pmr::vector<bool>          reached;  // per specialization: called by code that is lowered
+	std::pmr::vector<bool>          loops;    // per specialization: calls itself in tail position, thus jumps back to its top
+	std::pmr::vector<ASTNodeIndex>  saved;    // captured var inits of the lets enclosing the expression being lowered, outermost first
+	std::pmr::vector<uint32_t>      reach;    // specializations reached, in order of discovery
+	std::pmr::vector<Operand>       args;     // args of the calls being lowered
+	std::pmr::vector<ASTReturnType> sig;      // arg types of the call being lowered
+	Specializer                     types;
+
+	void emit(FILE* f, const ASTNodes& tree, const SymbolTable& symbols);
+
+private:
+	// state of the function being lowered
+	FILE*    out;     // null while inferring types
+	uint32_t cur;     // specialization, none for main
+	uint32_t depth;   // lexical depth of function
+	uint32_t temps;   // count of temps
+	uint32_t level;   // indentation level
+
+	const SymbolTable* symbols;
+
+	ASTReturnType getType(const ASTNodeIndex index) const { return types.types[index]; }
+	void indent() const;
+	void printType(const ASTReturnType type) const;
+	void printAs(const Operand& op, const ASTReturnType type) const;
+	void printName(const uint32_t spec, const ASTNodes& tree) const;
+	void printHeader(const uint32_t spec, const ASTNodes& tree) const;
+	void lowerFunction(const uint32_t spec, const ASTNodes& tree);
+	void lowerMain(const ASTNodes& tree);
+	Operand lowerBody(ASTNodeIndex it, const bool tail, const ASTNodes& tree);
+	Operand lowerExpr(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	Operand lowerLet(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	Operand lowerArith(const ASTNodeIndex index, const ASTNodes& tree);
+	Operand lowerIf(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+	Operand lowerCall(const ASTNodeIndex index, const bool tail, const ASTNodes& tree);
+};
+
+// runtime of the C translation unit; arithmetic and i/o are the same as those of the evaluators
+const char csourceRuntime[] =
+	"#include <stdint.h>\n"
+	"#include <stdio.h>\n"
+	"#include <stdlib.h>\n"
+	"#include <string.h>\n"
+	"\n"
+	"typedef struct { int32_t isf; int32_t i; float f; } tv; /* tagged value */\n"
+	"\n"
+	"static inline tv tv_i32(int32_t a) { tv r; r.isf = 0; r.i = a; r.f = 0.f; return r; }\n"
+	"static inline tv tv_f32(float a) { tv r; r.isf = 1; r.i = 0; r.f = a; return r; }\n"
+	"static inline float tv_flt(tv a) { return a.isf ? a.f : (float)a.i; }\n"
+	"static inline float f32_bits(uint32_t a) { float r; memcpy(&r, &a, sizeof(r)); return r; }\n"
+	"\n"
+	"static inline int32_t add_i32(int32_t a, int32_t b) { return (int32_t)((uint32_t)a + (uint32_t)b); }\n"
+	"static inline int32_t sub_i32(int32_t a, int32_t b) { return (int32_t)((uint32_t)a - (uint32_t)b); }\n"
+	"static inline int32_t mul_i32(int32_t a, int32_t b) { return (int32_t)((uint32_t)a * (uint32_t)b); }\n"
+	"static inline int32_t div_i32(int32_t a, int32_t b) { return a / b; }\n"
+	"\n"
+	"#define TV_ARITH(name, op) static inline tv tv_##name(tv a, tv b) \\\n"
+	"	{ return a.isf || b.isf ? tv_f32(tv_flt(a) op tv_flt(b)) : tv_i32(name##_i32(a.i, b.i)); }\n"
+	"\n"
+	"TV_ARITH(add, +)\n"
+	"TV_ARITH(sub, -)\n"
+	"TV_ARITH(mul, *)\n"
+	"TV_ARITH(div, /)\n"
+	"\n"
+	"static inline int tv_zero(tv a) { return a.isf ? 0.f == a.f : 0 == a.i; }\n"
+	"static inline int tv_neg(tv a) { return a.isf ? 0.f > a.f : 0 > a.i; }\n"
+	"\n"
+	"static inline int32_t print_i32(int32_t a) { printf(\"%d\\n\", a); return a; }\n"
+	"static inline float print_f32(float a) { printf(\"%f\\n\", a); return a; }\n"
+	"static inline tv print_tv(tv a) { if (a.isf) print_f32(a.f); else print_i32(a.i); return a; }\n"
+	"\n"
+	"static inline void invalid_input(void) { fprintf(stderr, \"runtime error: invalid input\\n\"); exit(-1); }\n"
+	"static inline int32_t read_i32(void) { int32_t r; printf(\"i: \"); if (1 != scanf(\"%d\", &r)) invalid_input(); return r; }\n"
+	"static inline float read_f32(void) { float r; printf(\"f: \"); if (1 != scanf(\"%f\", &r)) invalid_input(); return r; }\n"
+	"\n"
+	"static inline void result_i32(int32_t a) { printf(\"i32 %d\\n\", a); }\n"
+	"static inline void result_f32(float a) { printf(\"f32 %f\\n\", a); }\n"
+	"static inline void result_tv(tv a) { if (a.isf) result_f32(a.f); else result_i32(a.i); }\n"
+	"\n";
+
+// lower the AST to C, printing that to the given file
+void CSource::emit(FILE* f, const ASTNodes& tree, const SymbolTable& symbols)
+{
+	this->symbols = &symbols;
+	captured.assign(tree.size(), false);
+	read.assign(tree.size(), false);
+	declared.assign(tree.size(), false);
+
+	// vars read at a lexical depth shallower than that of the function reading them are captured; walk all functions, tracking
+	// the depth of the innermost one
+	std::pmr::vector< std::pair< ASTNodeIndex, uint32_t > > work(1, std::make_pair(ASTNodeIndex(0), uint32_t(0)));
+
+	while (!work.empty()) {
+		const ASTNodeIndex index = work.back().first;
+		const uint32_t fdepth = tree[index].isDefun() ? tree[index].depth : work.back().second;
+		work.pop_back();
+
+		if (ASTNODE_EVAL_VAR == tree[index].type) {
+			read[tree.info(index).init] = true;
+
+			if (tree[index].depth < fdepth)
+				captured[tree.info(index).init] = true;
+		}
+
+		for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next)
+			work.push_back(std::make_pair(it, fdepth));
+	}
+
+	// globals of captured vars take the join of the types of the var in all functions
+	types.whole = true;
+	types.infer(0, tree);
+
+	// only specializations reached from main are lowered, and only globals of the scopes lowered are declared, so that the C is
+	// free of unused functions, vars and labels; earlier passes of the inference may leave specializations that none calls
+	out = nullptr;
+	reached.assign(types.specs.size(), false);
+	loops.assign(types.specs.size(), false);
+	reach.clear();
+	lowerMain(tree);
+
+	for (size_t i = 0; i < reach.size(); ++i)
+		lowerFunction(reach[i], tree);
+
+	fprintf(f, "%s", csourceRuntime);
+
+	out = f;
+
+	for (ASTNodeIndex i = 0; i < tree.size(); ++i)
+		if (declared[i]) {
+			fprintf(f, "static ");
+			printType(types.joined[i]);
+			fprintf(f, " g%u;\n", i);
+		}
+
+	fprintf(f, "\n");
+
+	for (uint32_t i = 0; i < types.specs.size(); ++i)
+		if (reached[i]) {
+			printHeader(i, tree);
+			fprintf(f, ";\n");
+		}
+
+	for (uint32_t i = 0; i < types.specs.size(); ++i)
+		if (reached[i]) {
+			fprintf(f, "\n");
+			lowerFunction(i, tree);
+		}
+
+	fprintf(f, "\n");
+	lowerMain(tree);
+}
+
+void CSource::indent() const
+{
+	for (uint32_t i = 0; i < level; ++i)
+		fputc('\t', out);
+}
+
+void CSource::printType(const ASTReturnType type) const
+{
+	fprintf(out, "%s", ASTRETURN_F32 == type ? "float" : ASTRETURN_UNKNOWN == type ? "tv" : "int32_t");
+}
+
+// print an operand converted to the given type; conversions are only ever to a wider type
+void CSource::printAs(const Operand& op, const ASTReturnType type) const
+{
+	if (op.type == type)
+		fprintf(out, "%c%u", op.kind, op.id);
+	else
+	if (ASTRETURN_UNKNOWN == type)
+		fprintf(out, "tv_%s(%c%u)", ASTRETURN_F32 == op.type ? "f32" : "i32", op.kind, op.id);
+	else
+	if (ASTRETURN_F32 == type && ASTRETURN_I32 == op.type)
+		fprintf(out, "(float)%c%u", op.kind, op.id);
+	else
+		fprintf(out, "tv_flt(%c%u)", op.kind, op.id);
+}
+
+// print the name of a specialization -- node index, defun name and arg types, in that order
+void CSource::printName(const uint32_t spec, const ASTNodes& tree) const
+{
+	const ASTNodeIndex defun = types.specs[spec].defun;
+	const StrRef name = symbols->getName(tree.info(defun).symbol);
+
+	fprintf(out, "f%u_", defun);
+
+	for (size_t i = 0; i < name.len; ++i)
+		fputc(isalnum(uint8_t(name.ptr[i])) ? name.ptr[i] : '_', out);
+
+	fputc('_', out);
+
+	for (size_t i = 0, count = getSubCount(true, defun, tree); i < count; ++i) {
+		const ASTReturnType type = types.sigs[types.specs[spec].sig + i];
+		fputc(ASTRETURN_F32 == type ? 'f' : ASTRETURN_UNKNOWN == type ? 'u' : 'i', out);
+	}
+}
+
+void CSource::printHeader(const uint32_t spec, const ASTNodes& tree) const
+{
+	fprintf(out, "static ");
+	printType(types.specs[spec].rtype);
+	fputc(' ', out);
+	printName(spec, tree);
+	fputc('(', out);
+
+	uint32_t i = 0;
+
+	for (ASTNodeIndex it = tree[types.specs[spec].defun].first; nullidx != it && tree[it].isInitialize(); it = tree[it].next, ++i) {
+		fprintf(out, i ? ", " : "");
+		printType(types.sigs[types.specs[spec].sig + i]);
+		fprintf(out, " v%u", it);
+	}
+
+	fprintf(out, i ? ")" : "void)");
+}
+
+// lower a specialization to a C function
+void CSource::lowerFunction(const uint32_t spec, const ASTNodes& tree)
+{
+	const ASTNodeIndex defun = types.specs[spec].defun;
+	cur = spec;
+	depth = tree[defun].depth;
+	temps = 0;
+	level = 1;
+	types.typeFunction(spec, tree);
+
+	if (out) {
+		printHeader(spec, tree);
+		fprintf(out, "\n{\n");
+	}
+
+	ASTNodeIndex it = tree[defun].first;
+
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next) {
+		declared[it] = declared[it] || captured[it];
+
+		if (out && !read[it])
+			fprintf(out, "\t(void)v%u;\n", it);
+
+		if (out && captured[it]) {
+			fprintf(out, "\t");
+			printType(types.joined[it]);
+			fprintf(out, " s%u = g%u;\n", it, it);
+		}
+	}
+
+	// a call to self in tail position assigns the params and jumps here, so the globals of those are only saved once
+	if (out && loops[spec])
+		fprintf(out, "top:;\n");
+
+	for (ASTNodeIndex at = tree[defun].first; at != it; at = tree[at].next)
+		if (out && captured[at]) {
+			fprintf(out, "\tg%u = ", at);
+			printAs(Operand{ .type = getType(at), .kind = 'v', .id = at }, types.joined[at]);
+			fprintf(out, ";\n");
+		}
+
+	const Operand ret = lowerBody(it, true, tree);
+
+	if (out && 'j' != ret.kind) {
+		for (it = tree[defun].first; nullidx != it && tree[it].isInitialize(); it = tree[it].next)
+			if (captured[it])
+				fprintf(out, "\tg%u = s%u;\n", it, it);
+
+		fprintf(out, "\treturn ");
+		printAs(ret, types.specs[spec].rtype);
+		fprintf(out, ";\n");
+	}
+
+	if (out)
+		fprintf(out, "}\n");
+}
+
+void CSource::lowerMain(const ASTNodes& tree)
+{
+	cur = uint32_t(-1);
+	depth = 0;
+	temps = 0;
+	level = 1;
+	types.typeRoot(0, tree);
+
+	if (out)
+		fprintf(out, "int main(void)\n{\n");
+
+	const Operand ret = lowerBody(tree[0].first, false, tree);
+
+	if (out) {
+		fprintf(out, "\tresult_%s(", ASTRETURN_F32 == ret.type ? "f32" : ASTRETURN_UNKNOWN == ret.type ? "tv" : "i32");
+		printAs(ret, ret.type);
+		fprintf(out, ");\n\treturn 0;\n}\n");
+	}
+}
+
+// lower the sub-expressions of a scope past its var inits; return the result of the last one, which is in tail position if the
+// scope is
+CSource::Operand CSource::lowerBody(ASTNodeIndex it, const bool tail, const ASTNodes& tree)
+{
+	Operand ret{ .type = ASTRETURN_NONE };
+	ASTNodeIndex last = nullidx;
+
+	for (ASTNodeIndex at = it; nullidx != at; at = tree[at].next)
+		if (!tree[at].isDefun())
+			last = at;
+
+	for (; nullidx != it; it = tree[it].next) {
+		if (tree[it].isDefun())
+			continue;
+
+		ret = lowerExpr(it, tail && last == it, tree);
+
+		// results of all but the last sub-expression are discarded
+		if (out && last != it) {
+			indent();
+			fprintf(out, "(void)%c%u;\n", ret.kind, ret.id);
+		}
+	}
+
+	return ret;
+}
+
+CSource::Operand CSource::lowerExpr(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const ASTNode& node = tree[index];
+	Operand ret{ .type = ASTRETURN_NONE };
+
+	switch (node.type) {
+	case ASTNODE_LET:
+		ret = lowerLet(index, tail, tree);
+		break;
+	case ASTNODE_EVAL_VAR:
+		{
+			// vars of enclosing functions are read from their globals
+			const ASTNodeIndex init = tree.info(index).init;
+			ret = Operand{ .type = getType(index), .kind = node.depth < depth ? 'g' : 'v', .id = init };
+			break;
+		}
+	case ASTNODE_EVAL_FUN:
+		switch (node.eval) {
+		case INTRIN_PLUS:
+		case INTRIN_MINUS:
+		case INTRIN_MUL:
+		case INTRIN_DIV:
+			ret = lowerArith(index, tree);
+			break;
+		case INTRIN_IFZERO:
+		case INTRIN_IFNEG:
+			ret = lowerIf(index, tail, tree);
+			break;
+		case INTRIN_PRINT:
+			{
+				const Operand arg = lowerExpr(node.first, false, tree);
+				ret = Operand{ .type = arg.type, .kind = 't', .id = temps++ };
+
+				if (out) {
+					indent();
+					printType(ret.type);
+					fprintf(out, " t%u = print_%s(", ret.id, ASTRETURN_F32 == arg.type ? "f32" : ASTRETURN_UNKNOWN == arg.type ? "tv" : "i32");
+					printAs(arg, arg.type);
+					fprintf(out, ");\n");
+				}
+				break;
+			}
+		case INTRIN_READ_I32:
+		case INTRIN_READ_F32:
+			{
+				const bool f32 = INTRIN_READ_F32 == node.eval;
+				ret = Operand{ .type = f32 ? ASTRETURN_F32 : ASTRETURN_I32, .kind = 't', .id = temps++ };
+
+				if (out) {
+					indent();
+					fprintf(out, "%s t%u = read_%s();\n", f32 ? "float" : "int32_t", ret.id, f32 ? "f32" : "i32");
+				}
+				break;
+			}
+		default:
+			ret = lowerCall(index, tail, tree);
+			break;
+		}
+		break;
+	case ASTNODE_LITERAL:
+		ret = Operand{ .type = ASTRETURN_F32 == node.rtype ? ASTRETURN_F32 : ASTRETURN_I32, .kind = 't', .id = temps++ };
+
+		if (out) {
+			indent();
+
+			if (ASTRETURN_F32 == ret.type)
+				fprintf(out, "float t%u = f32_bits(0x%08xu); /* %f */\n", ret.id, uint32_t(node.literal_i32), node.literal_f32);
+			else
+			if (INT32_MIN == node.literal_i32)
+				fprintf(out, "int32_t t%u = -2147483647 - 1;\n", ret.id);
+			else
+				fprintf(out, "int32_t t%u = %d;\n", ret.id, node.literal_i32);
+		}
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	return ret;
+}
+
+CSource::Operand CSource::lowerLet(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const Operand ret{ .type = getType(index), .kind = 't', .id = temps++ };
+	ASTNodeIndex it = tree[index].first;
+
+	if (out) {
+		indent();
+		printType(ret.type);
+		fprintf(out, " t%u;\n", ret.id);
+		indent();
+		fprintf(out, "{\n");
+	}
+
+	level++;
+
+	for (; nullidx != it && tree[it].isInitialize(); it = tree[it].next) {
+		const Operand var = lowerExpr(tree[it].first, false, tree);
+		declared[it] = declared[it] || captured[it];
+
+		if (out) {
+			indent();
+			printType(var.type);
+			fprintf(out, " v%u = ", it);
+			printAs(var, var.type);
+			fprintf(out, ";\n");
+
+			if (!read[it]) {
+				indent();
+				fprintf(out, "(void)v%u;\n", it);
+			}
+		}
+	}
+
+	// a var is not visible until its frame is complete
+	const size_t mark = saved.size();
+
+	for (ASTNodeIndex at = tree[index].first; at != it; at = tree[at].next)
+		if (captured[at]) {
+			saved.push_back(at);
+
+			if (out) {
+				indent();
+				printType(types.joined[at]);
+				fprintf(out, " s%u = g%u;\n", at, at);
+				indent();
+				fprintf(out, "g%u = ", at);
+				printAs(Operand{ .type = getType(at), .kind = 'v', .id = at }, types.joined[at]);
+				fprintf(out, ";\n");
+			}
+		}
+
+	const Operand body = lowerBody(it, tail, tree);
+	saved.resize(mark);
+
+	// past a jump the globals are restored already and the result is never used
+	if (out && 'j' == body.kind) {
+		indent();
+		fprintf(out, "(void)t%u;\n", ret.id);
+	}
+	else if (out) {
+		indent();
+		fprintf(out, "t%u = ", ret.id);
+		printAs(body, ret.type);
+		fprintf(out, ";\n");
+
+		for (ASTNodeIndex at = tree[index].first; at != it; at = tree[at].next)
+			if (captured[at]) {
+				indent();
+				fprintf(out, "g%u = s%u;\n", at, at);
+			}
+	}
+
+	level--;
+
+	if (out) {
+		indent();
+		fprintf(out, "}\n");
+	}
+
+	return Operand{ .type = body.type, .kind = 'j' == body.kind ? 'j' : 't', .id = ret.id };
+}
+
+CSource::Operand CSource::lowerArith(const ASTNodeIndex index, const ASTNodes& tree)
+{
+	static const char* const names[] = { "add", "sub", "mul", "div" };
+	static const char* const ops[] = { "+", "-", "*", "/" };
+	const size_t op = INTRIN_PLUS - tree[index].eval;
+
+	ASTNodeIndex it = tree[index].first;
+	Operand acc = lowerExpr(it, false, tree);
+
+	// arithmetic intrinsics have at least two args, folded left to right; mixed operands are promoted to f32
+	for (it = tree[it].next; nullidx != it; it = tree[it].next) {
+		const Operand arg = lowerExpr(it, false, tree);
+		const ASTReturnType type = getArithType(acc.type, arg.type);
+		const Operand ret{ .type = type, .kind = 't', .id = temps++ };
+
+		if (out) {
+			indent();
+			printType(type);
+			fprintf(out, " t%u = ", ret.id);
+
+			if (ASTRETURN_F32 == type) {
+				printAs(acc, type);
+				fprintf(out, " %s ", ops[op]);
+				printAs(arg, type);
+			}
+			else {
+				fprintf(out, ASTRETURN_UNKNOWN == type ? "tv_%s(" : "%s_i32(", names[op]);
+				printAs(acc, type);
+				fprintf(out, ", ");
+				printAs(arg, type);
+				fprintf(out, ")");
+			}
+
+			fprintf(out, ";\n");
+		}
+
+		acc = ret;
+	}
+
+	return acc;
+}
+
+CSource::Operand CSource::lowerIf(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const bool ifzero = INTRIN_IFZERO == tree[index].eval;
+	const ASTNodeIndex pred = tree[index].first;
+	const ASTNodeIndex then = tree[pred].next;
+	const Operand cond = lowerExpr(pred, false, tree);
+	const Operand ret{ .type = getType(index), .kind = 't', .id = temps++ };
+
+	if (out) {
+		indent();
+		printType(ret.type);
+		fprintf(out, " t%u;\n", ret.id);
+		indent();
+
+		if (ASTRETURN_UNKNOWN == cond.type)
+			fprintf(out, "if (tv_%s(%c%u)) {\n", ifzero ? "zero" : "neg", cond.kind, cond.id);
+		else
+			fprintf(out, "if (%s %s %c%u) {\n", ASTRETURN_F32 == cond.type ? "0.f" : "0", ifzero ? "==" : ">", cond.kind, cond.id);
+	}
+
+	level++;
+	const Operand a = lowerExpr(then, tail, tree);
+
+	if (out && 'j' != a.kind) {
+		indent();
+		fprintf(out, "t%u = ", ret.id);
+		printAs(a, ret.type);
+		fprintf(out, ";\n");
+	}
+
+	level--;
+
+	if (out) {
+		indent();
+		fprintf(out, "}\n");
+		indent();
+		fprintf(out, "else {\n");
+	}
+
+	level++;
+	const Operand b = lowerExpr(tree[then].next, tail, tree);
+
+	if (out && 'j' != b.kind) {
+		indent();
+		fprintf(out, "t%u = ", ret.id);
+		printAs(b, ret.type);
+		fprintf(out, ";\n");
+	}
+
+	level--;
+
+	if (out) {
+		indent();
+		fprintf(out, "}\n");
+	}
+
+	// both branches jumping leave the result unused
+	if (out && 'j' == a.kind && 'j' == b.kind) {
+		indent();
+		fprintf(out, "(void)t%u;\n", ret.id);
+	}
+
+	return Operand{ .type = ret.type, .kind = 'j' == a.kind && 'j' == b.kind ? 'j' : 't', .id = ret.id };
+}
+
+CSource::Operand CSource::lowerCall(const ASTNodeIndex index, const bool tail, const ASTNodes& tree)
+{
+	const size_t mark = args.size();
+	bool known = true;
+
+	for (ASTNodeIndex it = tree[index].first; nullidx != it; it = tree[it].next) {
+		const Operand arg = lowerExpr(it, false, tree);
+		args.push_back(arg);
+		known &= ASTRETURN_NONE != arg.type;
+	}
+
+	// the callee cannot be told till the types of all args are
+	if (!known) {
+		args.resize(mark);
+		return Operand{ .type = ASTRETURN_NONE, .kind = 't', .id = temps++ };
+	}
+
+	const uint32_t count = args.size() - mark;
+	sig.clear();
+
+	for (uint32_t i = 0; i < count; ++i)
+		sig.push_back(args[mark + i].type);
+
+	// all specializations were made by the specializer
+	const size_t specCount = types.specs.size();
+	const uint32_t spec = types.getSpec(tree[index].eval, sig.data(), count);
+	const Operand ret{ .type = types.specs[spec].rtype, .kind = cur == spec && tail ? 'j' : 't', .id = temps++ };
+	assert(specCount == types.specs.size());
+	(void) specCount;
+
+	if (!reached[spec]) {
+		reached[spec] = true;
+		reach.push_back(spec);
+	}
+
+	// a call to self in tail position copies the args aside before any param is overwritten, unwinds the lets it is in, and
+	// jumps back to the top of the function
+	if ('j' == ret.kind) {
+		loops[spec] = true;
+
+		if (out) {
+			for (uint32_t i = 0; i < count; ++i) {
+				indent();
+				printType(args[mark + i].type);
+				fprintf(out, " t%u = ", temps);
+				printAs(args[mark + i], args[mark + i].type);
+				fprintf(out, ";\n");
+				args[mark + i] = Operand{ .type = args[mark + i].type, .kind = 't', .id = temps++ };
+			}
+
+			for (size_t i = saved.size(); i--; ) {
+				indent();
+				fprintf(out, "g%u = s%u;\n", saved[i], saved[i]);
+			}
+
+			ASTNodeIndex it = tree[types.specs[spec].defun].first;
+
+			for (uint32_t i = 0; i < count; ++i, it = tree[it].next) {
+				indent();
+				fprintf(out, "v%u = %c%u;\n", it, args[mark + i].kind, args[mark + i].id);
+			}
+
+			indent();
+			fprintf(out, "goto top;\n");
+		}
+
+		args.resize(mark);
+		return ret;
+	}
+
+	if (out) {
+		indent();
+		printType(ret.type);
+		fprintf(out, " t%u = ", ret.id);
+		printName(spec, tree);
+		fputc('(', out);
+
+		for (uint32_t i = 0; i < count; ++i) {
+			fprintf(out, i ? ", " : "");
+			printAs(args[mark + i], args[mark + i].type);
+		}
+
+		fprintf(out, ");\n");
+	}
+
+	args.resize(mark);
+	return ret;
+}
+
+// parse all top-level expressions/statements, registering them as sub-nodes of a dummy root node; return false if error
+bool getRoot(const TokenStream& tokens, ASTNodes& tree)
+{
+	const ASTNode root = { .depth = 0, .type = ASTNODE_LET, .rtype = ASTRETURN_NONE };
+	const ASTNodeInfo rootinfo = { .symbol = nullsym, .parent = nullidx };
+	tree.push(root, rootinfo);
+
+	ScopeTable scopes;
+	std::pmr::vector<ParseFrame> frames;
+	size_t start_it = 0;
+	size_t len_it = tokens.size();
+	while (len_it) {
+		const size_t span = getNode(tokens, start_it, len_it, 0, tree, scopes, frames);
+
+		if (size_t(-1) == span)
+			return false;
+
+		start_it += span;
+		len_it -= span;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// front-end benchmarking
+
+// shapes of synthetic corpora
+enum CorpusShape : uint8_t {
+	CORPUS_UNKNOWN,
+	CORPUS_DEFUNS,     // many top-level defuns
+	CORPUS_NESTED,     // a single deeply-nested expression
+	CORPUS_LITERALS,   // literal-heavy arithmetic
+	CORPUS_IDENTIFIERS // identifier-heavy lets with long var names
+};
+
+CorpusShape getCorpusShape(const char* name)
+{
+	if (0 == strcmp(name, "defuns"))
+		return CORPUS_DEFUNS;
+	if (0 == strcmp(name, "nested"))
+		return CORPUS_NESTED;
+	if (0 == strcmp(name, "literals"))
+		return CORPUS_LITERALS;
+	if (0 == strcmp(name, "identifiers"))
+		return CORPUS_IDENTIFIERS;
+
+	return CORPUS_UNKNOWN;
+}
+
+// splitmix64 -- a seeded generator with the same output on every platform
+struct CorpusRandom {
+	uint64_t state;
+
+	uint64_t next() {
+		uint64_t z = state += 0x9e3779b97f4a7c15;
+		z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9;
+		z = (z ^ z >> 27) * 0x94d049bb133111eb;
+		return z ^ z >> 31;
+	}
+
+	uint32_t below(const uint32_t n) { return uint32_t(next() % n); }
+};
+
+// emit a numeric literal of random form: decimal or hexadecimal integer, or decimal float
+size_t emitLiteral(FILE* f, CorpusRandom& rnd)
+{
+	switch (rnd.below(3)) {
+	case 0:
+		return fprintf(f, " %d", int32_t(rnd.below(2000000)) - 1000000);
+	case 1:
+		return fprintf(f, " 0x%x", rnd.below(1 << 24));
+	}
+
+	return fprintf(f, " %u.%u", rnd.below(10000), rnd.below(1000));
+}
+
+// emit an identifier made of a random-length alphabetic stem and a disambiguating numeric suffix
+size_t emitIdentifier(FILE* f, CorpusRandom& rnd, const char* prefix, const size_t suffix, const size_t maxStem)
+{
+	static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz_";
+	size_t ret = fprintf(f, "%s", prefix);
+
+	for (size_t i = 1 + rnd.below(maxStem); i; --i, ++ret)
+		fputc(alphabet[rnd.below(countof(alphabet) - 1)], f);
+
+	return ret + fprintf(f, "%zu", suffix);
+}
+
+// check a span of the form the tokenizer hands over as a literal candidate -- an optional sign, an optional hexadecimal prefix,
+// literal-allowed characters and at most one decimal point -- against the reference reading of the span
+bool checkLiteralSpan(const char* str, const size_t len)
+{
+	const TriState hassign = isSign(str, str + len);
+	const size_t offset = hassign ? 1 : 0;
+	const bool hex = 2 <= len - offset && '0' == str[offset] && ('X' == str[offset + 1] || 'x' == str[offset + 1]);
+
+	int32_t lit_i32 = 0;
+	float lit_f32 = 0;
+	const Token literal = getLiteral(str, len, hassign, hex, lit_i32, lit_f32);
+	return checkLiteral(str, len, hassign, hex, literal, lit_i32, lit_f32);
+}
+
+// differential self-check of literal parsing against sscanf, in any build, over edge cases and a seeded sweep of random literal
+// candidates; print the candidates that disagree to stderr; return their count
+size_t checkLiterals(const size_t count, const uint64_t seed)
+{
+	static const char* const edges[] = {
+		// integral limits and past those -- integers saturate to 64 bits, then truncate to 32 bits
+		"2147483647", "+2147483647", "-2147483648", "2147483648", "-2147483649", "4294967295", "4294967296",
+		"9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809", "99999999999999999999",
+		"0x7fffffff", "0x80000000", "-0x80000000", "0xffffffff", "-0XFFFFFFFF", "0x100000000", "0xffffffffffffffffff",
+		// hexadecimal floats
+		"0x1.8", "0x.", "-0x.", "0x.8", "-0X.4", "0x1.", "0xA.b", "0x.0000001", "0xffffffffffffffff.8",
+		// a decimal point with digits on one side only, or none
+		".5", "5.", "-.5", "+5.", "-0.", ".0", ".", "-.",
+		// exponents without digits, and with
+		"1e", "1E", "-1e", "1.5e", ".5e", "5.e", "0e", "1e3", "1E38", "1e39", "0.1e1", "1e100000000000000000000",
+		// values rounding at 2^24, past which f32 has no unit bit
+		"16777216", "16777217.0", "16777217.", "16777218.5", "16777219.0", "33554433.0", "1677721.7e1", "16777217e0",
+		"0x1000001.", "0x1000003.0", "0x1000001.00000000000001", "16777217.000000000000000000001",
+		// long mantissas, and magnitudes at the ends of the f32 range
+		"0.1", "3.4028235e38", "3.4028236e38", "0.00000000000000000000000000000000000000000000140129846",
+		"0.000000000000000000000000000000000000000000000000001", "1.00000000000000000000000000000001",
+		"123456789012345678901234567890"
+	};
+
+	static const char digits[] = "0123456789abcdefABCDEF";
+	size_t failed = 0;
+
+	for (size_t i = 0; i < countof(edges); ++i)
+		if (!checkLiteralSpan(edges[i], strlen(edges[i]))) {
+			fprintf(stderr, "literal mismatch: %s\n", edges[i]);
+			failed++;
+		}
+
+	CorpusRandom rnd = { .state = seed };
+	char buf[64];
+
+	for (size_t n = 0; n < count; ++n) {
+		size_t len = 0;
+
+		if (rnd.below(4) == 0)
+			buf[len++] = rnd.below(2) ? '-' : '+';
+
+		const bool hex = rnd.below(4) == 0;
+
+		if (hex) {
+			buf[len++] = '0';
+			buf[len++] = rnd.below(2) ? 'x' : 'X';
+		}
+
+		// mostly decimal digits, so that decimal literals are not too rare
+		const size_t point = rnd.below(2) ? rnd.below(16) : size_t(-1);
+
+		for (size_t i = 0, runLen = rnd.below(24); i < runLen; ++i) {
+			if (point == i)
+				buf[len++] = '.';
+
+			buf[len++] = digits[rnd.below(4) ? rnd.below(10) : rnd.below(countof(digits) - 1)];
+		}
+
+		if (!len)
+			continue;
+
+		if (!checkLiteralSpan(buf, len)) {
+			fprintf(stderr, "literal mismatch: %.*s\n", int(len), buf);
+			failed++;
+		}
+	}
+
+	return failed;
+}
+
+// emit a syntactically and semantically valid program of roughly the specified size in bytes
+void generateCorpus(FILE* f, const CorpusShape shape, const size_t size, const uint64_t seed)
+{
+	CorpusRandom rnd = { .state = seed };
+	size_t len = 0;
+
+	switch (shape) {
+	case CORPUS_DEFUNS:
+		// defuns of three args, each calling its predecessor
+		len += fprintf(f, "(defun f0(a b c) (+ a b c))\n");
+		for (size_t i = 1; len < size; ++i) {
+			len += fprintf(f, "(defun f%zu(a b c)\n\t(ifneg a (- b c", i);
+			len += emitLiteral(f, rnd);
+			len += fprintf(f, ") (f%zu (- a 1) (* b", i - 1);
+			len += emitLiteral(f, rnd);
+			len += fprintf(f, ") (+ c a))))\n");
+
+			if (size <= len)
+				len += fprintf(f, "(f%zu 2 3 4)\n", i);
+		}
+		break;
+
+	case CORPUS_NESTED:
+		{
+			// alternate arithmetic and single-var lets, each let referring to the var of the previous one
+			size_t depth = 0;
+			size_t vars = 0;
+			len += fprintf(f, "(let ((v0 1))");
+
+			for (; len < size / 2 + 1; ++depth) {
+				if (rnd.below(4))
+					len += fprintf(f, "\n(%c v%zu", "+-*"[rnd.below(3)], vars);
+				else {
+					len += fprintf(f, "\n(let ((v%zu v%zu))", vars + 1, vars);
+					vars++;
+				}
+			}
+
+			len += fprintf(f, " v%zu", vars);
+			for (size_t i = 0; i <= depth; ++i)
+				fputc(')', f);
+
+			fputc('\n', f);
+		}
+		break;
+
+	case CORPUS_LITERALS:
+		// lines of long arithmetic expressions over literals
+		while (len < size) {
+			len += fprintf(f, "(%c", "+-*"[rnd.below(3)]);
+
+			for (size_t i = 0; i < 16; ++i)
+				len += emitLiteral(f, rnd);
+
+			len += fprintf(f, ")\n");
+		}
+		break;
+
+	case CORPUS_IDENTIFIERS:
+		// lets introducing vars of long names, summed up in their body
+		for (size_t i = 0; len < size; ++i) {
+			const size_t varCount = 32;
+			const uint64_t state = rnd.state;
+
+			len += fprintf(f, "(let (");
+			for (size_t j = 0; j < varCount; ++j) {
+				len += emitIdentifier(f, rnd, "(", j, 48);
+				len += fprintf(f, " %zu)", j);
+			}
+
+			// replay the generator to repeat the var names
+			rnd.state = state;
+			len += fprintf(f, ")\n\t(+");
+			for (size_t j = 0; j < varCount; ++j)
+				len += emitIdentifier(f, rnd, " ", j, 48);
+
+			len += fprintf(f, "))\n");
+		}
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+}
+
+// get a monotonic time in seconds
+double getTime()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// get the peak resident set size of the process so far, in KiB
+long getPeakRSS()
+{
+	rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+// get the heap footprint of a token stream, in bytes
+size_t getFootprint(const TokenStream& tokens)
+{
+	return tokens.kind.capacity() * sizeof(tokens.kind.front()) +
+		tokens.offset.capacity() * sizeof(tokens.offset.front()) +
+		tokens.marks.capacity() * sizeof(tokens.marks.front()) +
+		tokens.ranks.capacity() * sizeof(tokens.ranks.front()) +
+		tokens.payloads.capacity() * sizeof(tokens.payloads.front()) +
+		tokens.newlines.capacity() * sizeof(tokens.newlines.front()) +
+		tokens.symbols.text.capacity() * sizeof(tokens.symbols.text.front()) +
+		tokens.symbols.names.capacity() * sizeof(tokens.symbols.names.front()) +
+		tokens.symbols.hashes.capacity() * sizeof(tokens.symbols.hashes.front()) +
+		tokens.symbols.slots.capacity() * sizeof(tokens.symbols.slots.front());
+}
+
+// get the heap footprint of an AST, in bytes
+size_t getFootprint(const ASTNodes& tree)
+{
+	return tree.nodes.capacity() * sizeof(ASTNode) + tree.infos.capacity() * sizeof(ASTNodeInfo);
+}
+
+// print the allocation counts of an arena as a JSON object
+void printArenaStats(FILE* f, const Arena& arena)
+{
+	fprintf(f, "{\"allocs\": %zu, \"alloc_bytes\": %zu, \"maps\": %zu, \"map_bytes\": %zu, \"peak_rss_kib\": %ld}\n",
+		arena.allocCount, arena.allocBytes, arena.mapCount, arena.mapBytes, getPeakRSS());
+}
+
+// print the counters of a JIT as a JSON object
+void printJitStats(FILE* f, const Jit& jit)
+{
+	fprintf(f, "{\"jit_functions\": %zu, \"jit_fallbacks\": %zu, \"jit_code_bytes\": %zu}\n", jit.doneCount, jit.failedCount, jit.used);
+}
+
+// print the counters of a memo table as a JSON object
+void printMemoStats(FILE* f, const MemoTable& memo)
+{
+	fprintf(f, "{\"memo_entries\": %zu, \"memo_hits\": %zu, \"memo_misses\": %zu, \"memo_evictions\": %zu}\n",
+		memo.entries.size(), memo.hits, memo.misses, memo.evictions);
+}
+
+// tokenize and parse a source, reporting the throughput, footprint and allocation counts of each phase as a JSON object per line;
+// return false if error
+bool benchFrontEnd(const char* source, const size_t sourceLen, const Arena& arena)
+{
+	TokenStream tokens;
+
+	const size_t a0 = arena.allocCount;
+	const size_t m0 = arena.mapCount;
+	const double t0 = getTime();
+	const bool tokenized = tokenize(source, sourceLen, tokens) && checkParentheses(tokens);
+	const double t1 = getTime();
+
+	if (!tokenized)
+		return false;
+
+	fprintf(stdout, "{\"phase\": \"tokenize\", \"bytes\": %zu, \"tokens\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.3f, \"tokens_per_s\": %.0f, "
+		"\"footprint_bytes\": %zu, \"allocs\": %zu, \"maps\": %zu, \"peak_rss_kib\": %ld}\n",
+		sourceLen, tokens.size(), t1 - t0, sourceLen / (t1 - t0) * 1e-6, tokens.size() / (t1 - t0), getFootprint(tokens),
+		arena.allocCount - a0, arena.mapCount - m0, getPeakRSS());
+
+	ASTNodes tree;
+
+	const size_t a2 = arena.allocCount;
+	const size_t m2 = arena.mapCount;
+	const double t2 = getTime();
+	const bool parsed = getRoot(tokens, tree);
+	const double t3 = getTime();
+
+	if (!parsed)
+		return false;
+
+	fprintf(stdout, "{\"phase\": \"parse\", \"tokens\": %zu, \"nodes\": %zu, \"seconds\": %.6f, \"tokens_per_s\": %.0f, \"nodes_per_s\": %.0f, "
+		"\"footprint_bytes\": %zu, \"allocs\": %zu, \"maps\": %zu, \"peak_rss_kib\": %ld}\n",
+		tokens.size(), tree.size(), t3 - t2, tokens.size() / (t3 - t2), tree.size() / (t3 - t2), getFootprint(tree),
+		arena.allocCount - a2, arena.mapCount - m2, getPeakRSS());
+
+	return true;
+}
+
+// map a source file into memory in its entirety; return false if the file cannot be mapped, e.g. if not a regular file
+bool mapSource(FILE* infile, const char*& source, size_t& sourceLen)
+{
+	struct stat st;
+
+	if (0 != fstat(fileno(infile), &st) || !S_ISREG(st.st_mode))
+		return false;
+
+	source = nullptr;
+	sourceLen = st.st_size;
+
+	if (0 == sourceLen)
+		return true;
+
+	void* const addr = mmap(nullptr, sourceLen, PROT_READ, MAP_PRIVATE, fileno(infile), 0);
+
+	if (MAP_FAILED == addr)
+		return false;
+
+	madvise(addr, sourceLen, MADV_SEQUENTIAL);
+	source = static_cast< const char* >(addr);
+	return true;
+}
+
+// evaluators of AST
+enum EvalMode : uint8_t {
+	EVAL_PARTIAL,  // partial evaluation, rewriting AST
+	EVAL_PURE,     // plain evaluation, leaving AST intact
+	EVAL_BYTECODE  // compilation to bytecode and execution of that
+};
+
+// read a source stream into a buffer in its entirety; return false on read error
+bool readSource(FILE* infile, std::vector<char>& buffer)
+{
+	const size_t chunksize = 1 << 20;
+	size_t len = 0;
+
+	do {
+		buffer.resize(len + chunksize);
+		len += fread(buffer.data() + len, sizeof(buffer.front()), chunksize, infile);
+	} while (len == buffer.size());
+
+	buffer.resize(len);
+	return !ferror(infile);
+}
+
+// parse and evaluate top-level expressions/statements as their tokens arrive from an input stream; the stream is read
+// in chunks and tokenized up to the last separator or parenthesis in a chunk, carrying any trailing partial token over
+// to the next chunk; every top-level form is parsed and evaluated as soon as its last token is seen, by the specified evaluator;
+// plain evaluation memoizes calls of pure defuns in the given table, if enabled, and calls native code by the given JIT, if any;
+// only defuns are retained past their evaluation, so that memory is bound by those rather than by the length of the stream
+int evalStream(FILE* infile, const EvalMode mode, MemoTable& memo, Jit* jit)
+{
+	const size_t chunksize = 1 << 16;
+
+	// chunks are retained only while tokens refer to them
+	std::vector< std::vector<char> > chunks;
+	TokenStream tokens;
+
+	ASTNodes tree;
+	const ASTNode root = { .depth = 0, .type = ASTNODE_LET, .rtype = ASTRETURN_NONE };
+	const ASTNodeInfo rootinfo = { .symbol = nullsym, .parent = nullidx };
+	tree.push(root, rootinfo);
+
+	ScopeTable scopes;
+	std::pmr::vector<ParseFrame> frames;
+	VarStack stack;
+	Bytecode bytecode;
+	VMStack vmstack;
+	size_t carry = 0;
+
+	if (memo.enabled())
+		stack.memo = &memo;
+
+	if (nullptr != jit)
+		jit->symbols = &tokens.symbols;
+
+	stack.jit = jit;
+
+	size_t scanned = 0;
+	size_t evalCount = 0;
+	unsigned depth = 0;
+	bool empty = true;
+	bool eof = false;
+
+	while (!eof) {
+		std::vector<char> chunk(carry + chunksize);
+
+		if (carry)
+			memcpy(chunk.data(), chunks.back().data() + chunks.back().size() - carry, carry);
+
+		ssize_t readCount;
+		do
+			readCount = read(fileno(infile), chunk.data() + carry, chunksize);
+		while (0 > readCount && EINTR == errno);
+
+		if (0 > readCount) {
+			fprintf(stdout, "failure reading input file\n");
+			return -1;
+		}
+
+		eof = 0 == readCount;
+		empty &= eof && !carry;
+
+		// chunk is trimmed to its content
+		const size_t len = carry + readCount;
+		chunk.resize(len);
+		chunk.shrink_to_fit();
+
+		// the trailing token of a chunk may continue in the next chunk, unless followed by a separator or a parenthesis
+		size_t cut = len;
+
+		if (!eof)
+			while (cut && !isSeparator(chunk.data() + cut - 1) && '(' != chunk[cut - 1] && ')' != chunk[cut - 1])
+				cut--;
+
+		carry = len - cut;
+
+		if (!tokenize(chunk.data(), cut, tokens)) {
+			fprintf(stdout, "failure\n");
+			return -1;
+		}
+
+		chunks.push_back(std::move(chunk));
+
+		// collect complete top-level expressions/statements, registering them as root sub-nodes, and evaluate them in order
+		size_t start_it = 0;
+
+		for (; scanned < tokens.size(); ++scanned) {
+			if (TOKEN_PARENTHESIS_L == tokens.token(scanned))
+				depth++;
+			else
+			if (TOKEN_PARENTHESIS_R == tokens.token(scanned) && depth)
+				depth--;
+
+			if (depth)
+				continue;
+
+			const ASTNodeIndex prevIdx = tree.info(0).last;
+			const size_t span = getNode(tokens, start_it, scanned + 1 - start_it, 0, tree, scopes, frames);
+
+			if (size_t(-1) == span) {
+				fprintf(stdout, "failure\n");
+				return -1;
+			}
+
+			assert(scanned + 1 - start_it == span);
+			start_it += span;
+
+			const ASTNodeIndex nodeIdx = tree.info(0).last;
+
+			if (tree[nodeIdx].isDefun())
+				continue;
+
+			// an expression nesting defuns is retained, as the evaluators keep per-defun state by AST node
+			bool nesting = false;
+
+			for (ASTNodeIndex i = nodeIdx + 1; i < tree.size() && !nesting; ++i)
+				nesting = tree[i].isDefun();
+
+			Value res;
+			uint32_t entry = 0;
+
+			switch (mode) {
+			case EVAL_PURE:
+				if (memo.enabled())
+					memo.analyze(tree);
+
+				stack.states.resize(tree.size(), NODE_UNINIT);
+				res = evalPure(nodeIdx, tree, stack);
+				break;
+			case EVAL_BYTECODE:
+				entry = bytecode.compile(nodeIdx, tree);
+				res = execute(bytecode, entry, vmstack);
+				break;
+			default:
+				res = eval(nodeIdx, tree, stack).value;
+				break;
+			}
+
+			res.print(stdout);
+			fflush(stdout);
+
+			evalCount++;
+
+			if (nesting)
+				continue;
+
+			// release the expression -- its nodes, along with any inlined into it by partial evaluation, are the last ones of the
+			// tree; so is its code
+			if (nullidx == prevIdx)
+				tree[0].first = nullidx;
+			else
+				tree[prevIdx].next = nullidx;
+
+			tree.info(0).last = prevIdx;
+			tree.truncate(nodeIdx);
+
+			switch (mode) {
+			case EVAL_PURE:
+				if (memo.enabled()) {
+					memo.facts.resize(nodeIdx);
+					memo.analyzed = nodeIdx;
+				}
+
+				stack.states.resize(nodeIdx);
+				break;
+			case EVAL_BYTECODE:
+				bytecode.code.resize(entry);
+				break;
+			default:
+				break;
+			}
+		}
+
+		tokens.erase(start_it);
+		scanned -= start_it;
+
+		// release chunks preceding the first one still spanned by tokens; the last chunk may carry over to the next one
+		size_t released = 0;
+
+		while (released + 1 < chunks.size() && (tokens.spans.empty() || chunks[released].data() != tokens.spans.front().ptr))
+			released++;
+
+		chunks.erase(chunks.begin(), chunks.begin() + released);
+	}
+
+	if (empty)
+		return 0;
+
+	// report any incomplete trailing expression
+	if (!checkParentheses(tokens)) {
+		fprintf(stdout, "failure\n");
+		return -1;
+	}
+
+	// root expression must return something
+	if (0 == evalCount) {
+		fprintf(stderr, "root expression does not return\nfailure\n");
+		return -1;
+	}
+
+	assert(stack.vars.empty());
+	return 0;
+}
+
+void printUsage(const char* name)
+{
+	fprintf(stderr, "usage: %s [--stream | --bench] [--vm | --pure [--memo entries] [--jit]] [--infer] [--stats] [--hugepages] [source_file]\n"
+		"       %s --emit-c [source_file]\n"
+		"       %s --gen {defuns | nested | literals | identifiers} size_bytes seed\n"
+		"       %s --check-literals\n", name, name, name, name);
+}
+
 int main(int argc, char** argv)
 {
 	FILE* infile = stdin;
+	bool stream = false;
+	bool bench = false;
+	bool stats = false;
+	size_t memoSize = 0;
+	bool native = false;
+	bool lower = false;
+	bool infer = false;
+	EvalMode mode = EVAL_PARTIAL;
+
+	// all containers of the front end and the evaluator allocate from the arena, released in bulk at exit
+	Arena arena;
+	std::pmr::set_default_resource(&arena);
+
+	for (int i = 1; i < argc; ++i) {
+		if (0 == strcmp(argv[i], "--stream")) {
+			stream = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--bench")) {
+			bench = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--vm") || 0 == strcmp(argv[i], "--pure")) {
+			const EvalMode m = 0 == strcmp(argv[i], "--vm") ? EVAL_BYTECODE : EVAL_PURE;
+
+			if (EVAL_PARTIAL != mode && m != mode) {
+				fprintf(stderr, "--vm and --pure are exclusive\n");
+				return -1;
+			}
+
+			mode = m;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--stats")) {
+			stats = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--memo")) {
+			// a positive count of entries, so neither a negative one nor the source file name past a missing count
+			char* end = nullptr;
+			const char* arg = i + 1 < argc ? argv[++i] : "";
+			memoSize = '0' <= arg[0] && '9' >= arg[0] ? strtoull(arg, &end, 0) : 0;
+
+			if (nullptr == end || '\0' != *end || 0 == memoSize || MemoTable::maxCapacity < memoSize) {
+				fprintf(stderr, "--memo requires a count of entries in [1, %zu]\n", MemoTable::maxCapacity);
+				printUsage(argv[0]);
+				return -1;
+			}
 
-	if (argc == 2) {
-		infile = fopen(argv[1], "r");
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--emit-c")) {
+			lower = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--infer")) {
+			infer = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--jit")) {
+			native = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--hugepages")) {
+			arena.hugePages = true;
+			continue;
+		}
+
+		if (0 == strcmp(argv[i], "--gen") && i + 3 < argc) {
+			const CorpusShape shape = getCorpusShape(argv[i + 1]);
+			const size_t size = strtoull(argv[i + 2], nullptr, 0);
+			const uint64_t seed = strtoull(argv[i + 3], nullptr, 0);
+
+			if (CORPUS_UNKNOWN == shape) {
+				fprintf(stderr, "unknown corpus shape: %s\n", argv[i + 1]);
+				return -1;
+			}
+
+			generateCorpus(stdout, shape, size, seed);
+			return 0;
+		}
+
+		if (0 == strcmp(argv[i], "--check-literals")) {
+			const bool failed = checkLiterals(1 << 20, 1);
+			fprintf(stdout, failed ? "failure\n" : "success\n");
+			return failed ? -1 : 0;
+		}
+
+		if (stdin != infile || ('-' == argv[i][0] && '-' == argv[i][1])) {
+			printUsage(argv[0]);
+			return -1;
+		}
+
+		infile = fopen(argv[i], "r");
 		if (nullptr == infile) {
 			fprintf(stdout, "failure reading input file\n");
 			return -1;
 		}
 	}
 
-	const size_t bufsize = 1 << 20;
-	std::vector<char> buffer(bufsize);
+	// memoization and native code are up to plain evaluation
+	if (memoSize && EVAL_PURE != mode) {
+		fprintf(stderr, "--memo requires --pure\n");
+		return -1;
+	}
+
+	if (native && EVAL_PURE != mode) {
+		fprintf(stderr, "--jit requires --pure\n");
+		return -1;
+	}
+
+	if (lower && stream) {
+		fprintf(stderr, "--emit-c requires the whole source\n");
+		return -1;
+	}
+
+	// neither lowering nor benchmarking the front end evaluates anything, so evaluation modes would go unused
+	if (lower && EVAL_PARTIAL != mode) {
+		fprintf(stderr, "--emit-c excludes --vm and --pure\n");
+		return -1;
+	}
+
+	if (bench && (stream || lower || infer || EVAL_PARTIAL != mode)) {
+		fprintf(stderr, "--bench excludes other modes\n");
+		return -1;
+	}
+
+	if (infer && stream) {
+		fprintf(stderr, "--infer requires the whole source\n");
+		return -1;
+	}
+
+	MemoTable memo;
+
+	if (memoSize)
+		memo.init(memoSize);
+
+	// without native code, all defuns are left to the interpreter
+	Jit jit;
+
+	if (native && !jit.init())
+		fprintf(stderr, "native code not available\n");
+
+	if (stream) {
+		const int ret = evalStream(infile, mode, memo, native ? &jit : nullptr);
+
+		if (infile != stdin)
+			fclose(infile);
+
+		if (stats)
+			printArenaStats(stderr, arena);
+
+		if (stats && memo.enabled())
+			printMemoStats(stderr, memo);
+
+		if (stats && native)
+			printJitStats(stderr, jit);
+
+		return ret;
+	}
+
+	// map regular files in place, read anything else into a buffer
+	std::vector<char> buffer;
+	const char* source;
+	size_t sourceLen;
+
+	const bool mapped = mapSource(infile, source, sourceLen);
+
+	if (!mapped) {
+		if (!readSource(infile, buffer)) {
+			fprintf(stdout, "failure reading input file\n");
+			return -1;
+		}
 
-	const size_t readCount = fread(buffer.data(), sizeof(buffer.front()), buffer.size() - 1, infile);
+		source = buffer.data();
+		sourceLen = buffer.size();
+	}
 
 	if (infile != stdin)
 		fclose(infile);
 
-	if (0 == readCount)
+	if (0 == sourceLen)
 		return 0;
 
-	std::vector<TokenInStream> tokens;
-	tokens.reserve(1024);
+	if (bench)
+		return benchFrontEnd(source, sourceLen, arena) ? 0 : -1;
 
-	if (!tokenize(buffer.data(), tokens)) {
+	TokenStream tokens;
+
+	if (!tokenize(source, sourceLen, tokens) || !checkParentheses(tokens)) {
 		fprintf(stdout, "failure\n");
 		return -1;
 	}
 
 #if 0
-	for (std::vector<TokenInStream>::const_iterator it = tokens.begin(); it != tokens.end(); ++it) {
-		it->print(stdout);
+	for (size_t i = 0; i < tokens.size(); ++i) {
+		tokens.print(stdout, i);
 		putc('\n', stdout);
 	}
 
 #endif
 	ASTNodes tree;
-	const ASTNode root = { .rtype = ASTRETURN_NONE, .type = ASTNODE_LET, .parent = nullidx };
-	tree.push_back(root);
-
-	// collect top-level expressions/statements, registering them as root sub-nodes
-	size_t start_it = 0;
-	size_t len_it = tokens.size();
-	while (len_it) {
-		const size_t span = getNode(tokens, start_it, len_it, 0, tree);
-
-		if (size_t(-1) == span) {
-			fprintf(stdout, "failure\n");
-			return -1;
-		}
 
-		start_it += span;
-		len_it -= span;
+	if (!getRoot(tokens, tree)) {
+		fprintf(stdout, "failure\n");
+		return -1;
 	}
 
 	// root expression must return something
@@ -1608,21 +6670,80 @@ int main(int argc, char** argv)
 		return -1;
 	}
 
+	// replace the return types assigned while parsing with whole-program ones, reporting the params of no single type
+	if (infer) {
+		TypeInference inference;
+		inference.infer(tree);
+		inference.report(stderr, tree, tokens.symbols);
+		inference.annotate(tree);
+	}
+
+	// lower AST to C in place of evaluating it
+	if (lower) {
+		CSource csource;
+		csource.emit(stdout, tree, tokens.symbols);
+		return 0;
+	}
+
 	// no use of printing the dummy root node -- print its sub-nodes instead
-	for (ASTNodeIndices::const_iterator it = tree.front().args.begin(); it != tree.front().args.end(); ++it)
-		tree[*it].print(stdout, tree, 0);
+	for (ASTNodeIndex it = tree[0].first; nullidx != it; it = tree[it].next)
+		tree.print(stdout, it, tokens.symbols, 0);
 
 	fprintf(stdout, "success\n");
 
-	// evaluate AST and print result
-	VarStack stack;
-	const Value res = eval(0, tree, stack);
-	res.print(stdout);
+	if (EVAL_BYTECODE == mode) {
+		// compile AST to bytecode, execute that and print result; AST is left intact, so no use of printing it again
+		Bytecode bytecode;
+		VMStack vmstack;
+		bytecode.types.annotated = infer;
+		const Value res = execute(bytecode, bytecode.compile(0, tree), vmstack);
+		res.print(stdout);
+	}
+	else
+	if (EVAL_PURE == mode) {
+		// evaluate AST without rewriting it and print result
+		VarStack stack;
+
+		if (memo.enabled()) {
+			memo.analyze(tree);
+			stack.memo = &memo;
+		}
+
+		if (native) {
+			jit.symbols = &tokens.symbols;
+			stack.jit = &jit;
+		}
+
+		stack.states.resize(tree.size(), NODE_UNINIT);
+		const Value res = evalPure(0, tree, stack);
+		res.print(stdout);
+
+		assert(stack.vars.empty());
+	}
+	else {
+		// evaluate AST and print result
+		VarStack stack;
+		const Value res = eval(0, tree, stack).value;
+		res.print(stdout);
+
+		// print AST past evaluation
+		for (ASTNodeIndex it = tree[0].first; nullidx != it; it = tree[it].next)
+			tree.print(stdout, it, tokens.symbols, 0);
+
+		assert(stack.vars.empty());
+	}
+
+	if (stats)
+		printArenaStats(stderr, arena);
+
+	if (stats && memo.enabled())
+		printMemoStats(stderr, memo);
+
+	if (stats && native)
+		printJitStats(stderr, jit);
 
-	// print AST past evaluation
-	for (ASTNodeIndices::const_iterator it = tree.front().args.begin(); it != tree.front().args.end(); ++it)
-		tree[*it].print(stdout, tree, 0);
+	if (mapped && sourceLen)
+		munmap(const_cast< char* >(source), sourceLen);
 
-	assert(stack.empty());
 	return 0;
 }